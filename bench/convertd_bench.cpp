@@ -0,0 +1,162 @@
+// Round-trip and throughput benchmark for convertd.
+//
+//     convertd_bench [--name NAME] [--seconds S]
+//
+// Needs a running convertd. Measures:
+//   rtt        one-value requests, one at a time (latency percentiles)
+//   pipelined  one-value requests, 64 in flight
+//   batch      8 MiB arrays, 4 in flight, against a plain memcpy of the
+//              same bytes in this process
+
+#include "convertclient.h"
+#include "unitmetrics.h"
+
+#include <QCoreApplication>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double secondsSince(Clock::time_point start)
+{
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+bool benchRoundTrip(ConvertClient &client, ConvertClient::UnitId from, ConvertClient::UnitId to, double seconds)
+{
+    UnitMetrics::Histogram latency;
+    double in = 1.0, out = 0.0;
+    std::uint64_t count = 0;
+
+    const auto start = Clock::now();
+    while (secondsSince(start) < seconds) {
+        const auto t0 = Clock::now();
+        if (client.convert(from, to, {&in, 1}, {&out, 1}) != ConvertClient::Status::Ok) {
+            std::fputs("convertd_bench: request failed\n", stderr);
+            return false;
+        }
+        const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - t0).count();
+        latency.buckets[UnitMetrics::Histogram::bucketFor(static_cast<std::uint64_t>(ns))] += 1;
+        ++count;
+    }
+
+    std::printf("rtt          %.0f req/s, p50 %.1f us, p99 %.1f us, p99.9 %.1f us\n",
+                static_cast<double>(count) / secondsSince(start),
+                latency.percentile(0.50) / 1e3, latency.percentile(0.99) / 1e3, latency.percentile(0.999) / 1e3);
+    return true;
+}
+
+bool benchPipelined(ConvertClient &client, ConvertClient::UnitId from, ConvertClient::UnitId to, double seconds)
+{
+    constexpr std::size_t Depth = 64;
+    std::vector<double> in(Depth, 1.0), out(Depth);
+    std::vector<ConvertClient::Ticket> tickets(Depth);
+    std::uint64_t count = 0;
+
+    for (std::size_t i = 0; i < Depth; ++i)
+        tickets[i] = client.submit(from, to, {&in[i], 1}, {&out[i], 1});
+
+    const auto start = Clock::now();
+    while (secondsSince(start) < seconds) {
+        for (std::size_t i = 0; i < Depth; ++i) {
+            if (client.wait(tickets[i]) != ConvertClient::Status::Ok) {
+                std::fputs("convertd_bench: request failed\n", stderr);
+                return false;
+            }
+            tickets[i] = client.submit(from, to, {&in[i], 1}, {&out[i], 1});
+            ++count;
+        }
+    }
+    const double elapsed = secondsSince(start);
+    for (ConvertClient::Ticket t : tickets) client.wait(t);
+
+    std::printf("pipelined    %.0f req/s (%zu in flight)\n", static_cast<double>(count) / elapsed, Depth);
+    return true;
+}
+
+bool benchBatch(ConvertClient &client, ConvertClient::UnitId from, ConvertClient::UnitId to, double seconds)
+{
+    constexpr std::size_t Depth = 4;
+    constexpr std::size_t Values = (8u << 20) / sizeof(double);
+    std::vector<std::vector<double>> in(Depth, std::vector<double>(Values, 1.5));
+    std::vector<std::vector<double>> out(Depth, std::vector<double>(Values));
+    std::vector<ConvertClient::Ticket> tickets(Depth);
+    std::uint64_t bytes = 0;
+
+    for (std::size_t i = 0; i < Depth; ++i)
+        tickets[i] = client.submit(from, to, in[i], out[i]);
+
+    const auto start = Clock::now();
+    while (secondsSince(start) < seconds) {
+        for (std::size_t i = 0; i < Depth; ++i) {
+            if (client.wait(tickets[i]) != ConvertClient::Status::Ok) {
+                std::fputs("convertd_bench: request failed\n", stderr);
+                return false;
+            }
+            tickets[i] = client.submit(from, to, in[i], out[i]);
+            bytes += Values * sizeof(double);
+        }
+    }
+    const double elapsed = secondsSince(start);
+    for (ConvertClient::Ticket t : tickets) client.wait(t);
+
+    // Reference: copying the same bytes once, in process
+    std::uint64_t copied = 0;
+    const auto copyStart = Clock::now();
+    while (secondsSince(copyStart) < seconds / 4) {
+        std::memcpy(out[0].data(), in[0].data(), Values * sizeof(double));
+        copied += Values * sizeof(double);
+    }
+    const double copyElapsed = secondsSince(copyStart);
+
+    std::printf("batch        %.2f GB/s of doubles converted (8 MiB frames, %zu in flight)\n",
+                static_cast<double>(bytes) / elapsed / 1e9, Depth);
+    std::printf("memcpy       %.2f GB/s\n", static_cast<double>(copied) / copyElapsed / 1e9);
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    QString name = ConvertProtocol::DefaultServerName;
+    double seconds = 3.0;
+    for (int i = 1; i < argc; ++i) {
+        if ((!std::strcmp(argv[i], "--name") || !std::strcmp(argv[i], "-n")) && i + 1 < argc) {
+            name = QString::fromLocal8Bit(argv[++i]);
+        } else if (!std::strcmp(argv[i], "--seconds") && i + 1 < argc && std::atof(argv[i + 1]) > 0) {
+            seconds = std::atof(argv[++i]);
+        } else {
+            std::fputs("usage: convertd_bench [--name NAME] [--seconds S]\n", stderr);
+            return 2;
+        }
+    }
+
+    ConvertClient client;
+    if (!client.connectToDaemon(name)) {
+        std::fprintf(stderr, "convertd_bench: cannot connect to %s: %s\n",
+                     name.toLocal8Bit().constData(), client.errorString().toLocal8Bit().constData());
+        return 1;
+    }
+
+    const ConvertClient::UnitId from = client.resolve("Miles");
+    const ConvertClient::UnitId to = client.resolve("Kilometers");
+    if (from == ConvertProtocol::InvalidUnit || to == ConvertProtocol::InvalidUnit) {
+        std::fputs("convertd_bench: daemon does not know Miles/Kilometers\n", stderr);
+        return 1;
+    }
+
+    // A failed request leaves the connection unusable; stop there
+    const bool ok = benchRoundTrip(client, from, to, seconds)
+                 && benchPipelined(client, from, to, seconds)
+                 && benchBatch(client, from, to, seconds);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,453 @@
+// Microbenchmarks for the conversion core.
+//
+//     converter_bench [--output FILE] [--quick]
+//
+// Measures per-call latency of the string, UnitId and plan paths for every
+// category, batch throughput, singleton access, getCategory, unitId and
+// getCurrencyRate lookups, combo-box population and rate-payload ingestion
+// for 5..500 currencies, the cost of enabling UnitMetrics, building and
+// searching the UnitCatalog, and ranked unit search over 10k units. Results are written as one JSON document (stdout
+// by default) so runs can be archived and diffed.
+
+#include "units.h"
+#include "conversionkernels.h"
+#include "ratespayload.h"
+#include "threadpool.h"
+#include "unitcatalog.h"
+#include "unitcombo.h"
+#include "unitmetrics.h"
+#include "unitsearch.h"
+
+#include <QApplication>
+#include <QComboBox>
+#include <QDateTime>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSysInfo>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Keeps results observable so the measured work is not optimised away
+volatile double sink = 0.0;
+
+struct Pair {
+    const char *category;
+    const char *from;
+    const char *to;
+};
+
+constexpr Pair Pairs[] = {
+    {"Length", "Meters", "Feet"},
+    {"Weight", "Kilograms", "Pounds"},
+    {"Volume", "Liters", "Gallons"},
+    {"Speed", "km/h", "mph"},
+    {"Temperature", "Celsius", "Fahrenheit"},
+    {"Currency", "USD", "EUR"},
+};
+
+struct Settings {
+    int repeats = 7;
+    std::size_t latencyOps = 2000000;
+    std::size_t batchElements = std::size_t(1) << 24;
+};
+
+// Runs `body(ops)` `repeats` times and returns the median ns per op
+template <class Body>
+double medianNsPerOp(const Settings &settings, std::size_t ops, Body body) {
+    std::vector<double> samples;
+    for (int r = 0; r < settings.repeats; ++r) {
+        const auto start = Clock::now();
+        body(ops);
+        const auto stop = Clock::now();
+        samples.push_back(std::chrono::duration<double, std::nano>(stop - start).count() / static_cast<double>(ops));
+    }
+    std::nth_element(samples.begin(), samples.begin() + samples.size() / 2, samples.end());
+    return samples[samples.size() / 2];
+}
+
+QJsonObject latencyResult(const QString &name, const QString &category, double nsPerOp, std::size_t ops) {
+    QJsonObject o;
+    o["name"] = name;
+    o["kind"] = "latency";
+    if (!category.isEmpty()) o["category"] = category;
+    o["ns_per_op"] = nsPerOp;
+    o["ops"] = static_cast<double>(ops);
+    return o;
+}
+
+QJsonObject throughputResult(const QString &name, const QString &category, double nsPerElement, std::size_t elements) {
+    QJsonObject o;
+    o["name"] = name;
+    o["kind"] = "throughput";
+    o["category"] = category;
+    o["elements"] = static_cast<double>(elements);
+    o["ns_per_element"] = nsPerElement;
+    o["melements_per_s"] = 1e3 / nsPerElement;
+    o["gb_per_s"] = 2.0 * sizeof(double) / nsPerElement;  // read + write
+    return o;
+}
+
+// Builds a provider-style payload with `count` currencies
+QByteArray makePayload(int count) {
+    QJsonObject rates;
+    const char *known[] = {"EUR", "ZAR", "GBP", "JPY"};
+    for (int i = 0; i < count; ++i) {
+        QString code = i < 4 ? QString(known[i]) : QString("C%1").arg(i, 3, 10, QChar('0'));
+        rates[code] = 0.5 + i * 0.01;
+    }
+    QJsonObject root;
+    root["base"] = "USD";
+    root["rates"] = rates;
+    return QJsonDocument(root).toJson(QJsonDocument::Compact);
+}
+
+/* ===================== BENCHMARKS ===================== */
+
+void benchConversions(const Settings &settings, QJsonArray &results) {
+    Units &units = Units::getInstance();
+
+    for (const Pair &p : Pairs) {
+        const QString from = p.from;
+        const QString to = p.to;
+        const UnitId fromId = units.unitId(from);
+        const UnitId toId = units.unitId(to);
+        const ConversionPlan plan = units.plan(fromId, toId);
+
+        results.append(latencyResult("convert_string", p.category,
+            medianNsPerOp(settings, settings.latencyOps, [&](std::size_t n) {
+                double acc = 0.0;
+                for (std::size_t i = 0; i < n; ++i) acc += units.convert(from, to, static_cast<double>(i));
+                sink = acc;
+            }), settings.latencyOps));
+
+        results.append(latencyResult("convert_id", p.category,
+            medianNsPerOp(settings, settings.latencyOps, [&](std::size_t n) {
+                double acc = 0.0;
+                for (std::size_t i = 0; i < n; ++i) acc += units.convert(fromId, toId, static_cast<double>(i));
+                sink = acc;
+            }), settings.latencyOps));
+
+        results.append(latencyResult("plan_build", p.category,
+            medianNsPerOp(settings, settings.latencyOps, [&](std::size_t n) {
+                double acc = 0.0;
+                for (std::size_t i = 0; i < n; ++i) acc += units.plan(fromId, toId).scale();
+                sink = acc;
+            }), settings.latencyOps));
+
+        results.append(latencyResult("plan_apply", p.category,
+            medianNsPerOp(settings, settings.latencyOps, [&](std::size_t n) {
+                double acc = 0.0;
+                for (std::size_t i = 0; i < n; ++i) acc += plan.apply(static_cast<double>(i));
+                sink = acc;
+            }), settings.latencyOps));
+
+        std::vector<double> in(settings.batchElements);
+        std::vector<double> out(settings.batchElements);
+        for (std::size_t i = 0; i < in.size(); ++i) in[i] = static_cast<double>(i % 4096);
+        units.convertBatch(fromId, toId, in, out);  // fault pages in
+
+        results.append(throughputResult("convert_batch", p.category,
+            medianNsPerOp(settings, in.size(), [&](std::size_t) {
+                units.convertBatch(fromId, toId, in, out);
+            }), in.size()));
+
+        results.append(throughputResult("convert_batch_parallel", p.category,
+            medianNsPerOp(settings, in.size(), [&](std::size_t) {
+                units.convertBatch(fromId, toId, in, out, WorkStealingPool::global());
+            }), in.size()));
+    }
+}
+
+void benchLookups(const Settings &settings, QJsonArray &results) {
+    Units &units = Units::getInstance();
+
+    results.append(latencyResult("singleton_access", QString(),
+        medianNsPerOp(settings, settings.latencyOps, [&](std::size_t n) {
+            std::size_t acc = 0;
+            for (std::size_t i = 0; i < n; ++i) acc += reinterpret_cast<std::uintptr_t>(&Units::getInstance());
+            sink = static_cast<double>(acc);
+        }), settings.latencyOps));
+
+    for (const Pair &p : Pairs) {
+        const QString unit = p.from;
+        results.append(latencyResult("get_category", p.category,
+            medianNsPerOp(settings, settings.latencyOps, [&](std::size_t n) {
+                int acc = 0;
+                UnitCategory category = UnitCategory::Length;
+                for (std::size_t i = 0; i < n; ++i) acc += units.getCategory(unit, category) ? static_cast<int>(category) : -1;
+                sink = acc;
+            }), settings.latencyOps));
+    }
+
+    // Canonical names, aliases, a non-ASCII alias and a miss
+    for (const char *name : {"Meters", "metres", "km/h", "\xC2\xB0" "C", "parsec"}) {
+        const QString unit = QString::fromUtf8(name);
+        const std::string_view utf8(name);
+        results.append(latencyResult(QString("unit_id ") + unit, QString(),
+            medianNsPerOp(settings, settings.latencyOps, [&](std::size_t n) {
+                std::size_t acc = 0;
+                for (std::size_t i = 0; i < n; ++i) acc += units.unitId(unit);
+                sink = static_cast<double>(acc);
+            }), settings.latencyOps));
+        results.append(latencyResult(QString("unit_id_utf8 ") + unit, QString(),
+            medianNsPerOp(settings, settings.latencyOps, [&](std::size_t n) {
+                std::size_t acc = 0;
+                for (std::size_t i = 0; i < n; ++i) acc += units.unitId(utf8);
+                sink = static_cast<double>(acc);
+            }), settings.latencyOps));
+    }
+
+    const QString usd = "USD";
+    const QString eur = "EUR";
+    results.append(latencyResult("get_currency_rate", "Currency",
+        medianNsPerOp(settings, settings.latencyOps, [&](std::size_t n) {
+            double acc = 0.0;
+            for (std::size_t i = 0; i < n; ++i) {
+                double rate = 0.0;
+                units.getCurrencyRate(usd, eur, rate);
+                acc += rate;
+            }
+            sink = acc;
+        }), settings.latencyOps));
+}
+
+void benchCatalog(const Settings &settings, QJsonArray &results) {
+    const std::size_t loads = 200;
+    results.append(latencyResult("catalog_load", QString(),
+        medianNsPerOp(settings, loads, [&](std::size_t n) {
+            std::size_t acc = 0;
+            for (std::size_t i = 0; i < n; ++i) acc += UnitCatalog().nameCount();
+            sink = static_cast<double>(acc);
+        }), loads));
+
+    const UnitCatalog &catalog = UnitCatalog::builtin();
+    QJsonObject size;
+    size["name"] = "catalog_size";
+    size["kind"] = "memory";
+    size["units"] = static_cast<double>(catalog.size());
+    size["names"] = static_cast<double>(catalog.nameCount());
+    size["bytes"] = static_cast<double>(catalog.memoryBytes());
+    size["bytes_per_unit"] = static_cast<double>(catalog.memoryBytes()) / static_cast<double>(catalog.size());
+    results.append(size);
+
+    // Every unit by symbol and by name, plus plural and capitalised forms
+    std::vector<QString> queries;
+    for (CatalogId id = 0; id < catalog.size(); ++id) {
+        const QString name = QString::fromUtf8(catalog.name(id).data(), qsizetype(catalog.name(id).size()));
+        queries.push_back(QString::fromUtf8(catalog.symbol(id).data(), qsizetype(catalog.symbol(id).size())));
+        queries.push_back(name);
+        queries.push_back(name + QChar('s'));
+        queries.push_back(name.left(1).toUpper() + name.mid(1));
+    }
+    results.append(latencyResult("catalog_find", QString(),
+        medianNsPerOp(settings, settings.latencyOps, [&](std::size_t n) {
+            std::size_t acc = 0;
+            for (std::size_t i = 0; i < n; ++i) acc += catalog.find(queries[i % queries.size()]);
+            sink = static_cast<double>(acc);
+        }), settings.latencyOps));
+}
+
+void benchSearch(const Settings &settings, QJsonArray &results) {
+    // 10k units: the catalogue's names and symbols, repeated with a suffix
+    constexpr std::uint32_t Items = 10000;
+    const UnitCatalog &catalog = UnitCatalog::builtin();
+    std::vector<std::string> names;
+    names.reserve(Items);
+    for (std::uint32_t i = 0; i < Items; ++i) {
+        const CatalogId id = static_cast<CatalogId>(i % catalog.size());
+        names.emplace_back(catalog.name(id));
+        if (i >= catalog.size()) names.back() += " v" + std::to_string(i / catalog.size());
+    }
+
+    UnitSearch search;
+    const std::size_t builds = 5;
+    results.append(latencyResult("unit_search_build", QString(),
+        medianNsPerOp(settings, builds, [&](std::size_t n) {
+            for (std::size_t i = 0; i < n; ++i) {
+                search = UnitSearch();
+                for (std::uint32_t item = 0; item < Items; ++item) {
+                    search.add(item, catalog.symbol(static_cast<CatalogId>(item % catalog.size())));
+                    search.add(item, names[item]);
+                }
+                search.build();
+            }
+            sink = static_cast<double>(search.keyCount());
+        }), builds));
+
+    // Exact, prefix, substring and misspelled input, as typed into a picker
+    const std::size_t ops = settings.latencyOps / 1000;
+    std::vector<UnitSearch::Match> matches;
+    for (const char *query : {"km", "kilometre", "kilomter", "per hour", "farenheit", "mm"}) {
+        results.append(latencyResult(QString("unit_search ") + query, QString(),
+            medianNsPerOp(settings, ops, [&](std::size_t n) {
+                std::size_t acc = 0;
+                for (std::size_t i = 0; i < n; ++i) {
+                    search.search(std::string_view(query), matches, 50);
+                    acc += matches.size();
+                }
+                sink = static_cast<double>(acc);
+            }), ops));
+    }
+}
+
+void benchPopulate(const Settings &settings, QJsonArray &results) {
+    QComboBox combo;
+    const std::size_t ops = settings.latencyOps / 100;
+    const char *names[] = {"Length", "Weight", "Temperature", "Volume", "Speed", "Currency"};
+
+    for (int c = 0; c <= static_cast<int>(UnitCategory::Currency); ++c) {
+        const UnitCategory category = static_cast<UnitCategory>(c);
+        results.append(latencyResult("populate_units", names[c],
+            medianNsPerOp(settings, ops, [&](std::size_t n) {
+                for (std::size_t i = 0; i < n; ++i)
+                    UnitCombo::populate(&combo, category);
+            }), ops));
+    }
+}
+
+void benchIngestion(const Settings &settings, QJsonArray &results) {
+    for (int count : {5, 50, 170, 500}) {
+        const QByteArray payload = makePayload(count);
+        const std::size_t ops = std::max<std::size_t>(10, settings.latencyOps / 20 / static_cast<std::size_t>(count));
+
+        QJsonObject parse = latencyResult("rates_parse", "Currency",
+            medianNsPerOp(settings, ops, [&](std::size_t n) {
+                for (std::size_t i = 0; i < n; ++i) {
+                    RateSnapshot snapshot;
+                    RatesPayload::parse(payload, snapshot);
+                    sink = static_cast<double>(snapshot.size());
+                }
+            }), ops);
+        parse["currencies"] = count;
+        parse["payload_bytes"] = static_cast<double>(payload.size());
+        results.append(parse);
+
+        // Same payload fed the way a download delivers it, one TCP segment at a time
+        constexpr qsizetype Segment = 1400;
+        QJsonObject chunked = latencyResult("rates_parse_chunked", "Currency",
+            medianNsPerOp(settings, ops, [&](std::size_t n) {
+                for (std::size_t i = 0; i < n; ++i) {
+                    RatesPayload::StreamParser parser;
+                    for (qsizetype at = 0; at < payload.size(); at += Segment)
+                        parser.feed(QByteArrayView(payload).sliced(at, std::min(Segment, payload.size() - at)));
+                    parser.finish();
+                    sink = static_cast<double>(parser.takeSnapshot().size());
+                }
+            }), ops);
+        chunked["currencies"] = count;
+        chunked["payload_bytes"] = static_cast<double>(payload.size());
+        results.append(chunked);
+
+        QJsonObject ingest = latencyResult("rates_ingest", "Currency",
+            medianNsPerOp(settings, ops, [&](std::size_t n) {
+                for (std::size_t i = 0; i < n; ++i) {
+                    RateSnapshot snapshot;
+                    RatesPayload::parse(payload, snapshot);
+                    Units::getInstance().publishRates(std::move(snapshot));
+                }
+            }), ops);
+        ingest["currencies"] = count;
+        ingest["payload_bytes"] = static_cast<double>(payload.size());
+        results.append(ingest);
+    }
+}
+
+// convert_id with UnitMetrics off and on, so the instrumentation overhead is visible
+void benchMetrics(const Settings &settings, QJsonArray &results) {
+    Units &units = Units::getInstance();
+    const bool wasEnabled = UnitMetrics::isEnabled();
+
+    for (const Pair &p : Pairs) {
+        const UnitId fromId = units.unitId(p.from);
+        const UnitId toId = units.unitId(p.to);
+
+        for (bool on : {false, true}) {
+            UnitMetrics::setEnabled(on);
+            results.append(latencyResult(on ? "convert_id_metrics_on" : "convert_id_metrics_off", p.category,
+                medianNsPerOp(settings, settings.latencyOps, [&](std::size_t n) {
+                    double acc = 0.0;
+                    for (std::size_t i = 0; i < n; ++i) acc += units.convert(fromId, toId, static_cast<double>(i));
+                    sink = acc;
+                }), settings.latencyOps));
+        }
+    }
+
+    UnitMetrics::setEnabled(wasEnabled);
+    UnitMetrics::reset();
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    // Combo boxes need a QApplication, but never a visible display
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    QApplication app(argc, argv);
+
+    Settings settings;
+    QString outputPath;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--quick") == 0) {
+            settings.repeats = 3;
+            settings.latencyOps = 200000;
+            settings.batchElements = std::size_t(1) << 20;
+        } else if ((std::strcmp(argv[i], "--output") == 0 || std::strcmp(argv[i], "-o") == 0) && i + 1 < argc) {
+            outputPath = QString::fromLocal8Bit(argv[++i]);
+        } else {
+            std::fprintf(stderr, "usage: converter_bench [--output FILE] [--quick]\n");
+            return 2;
+        }
+    }
+
+    // Currency conversions need rates; use a realistic payload size
+    {
+        RateSnapshot snapshot;
+        RatesPayload::parse(makePayload(170), snapshot);
+        Units::getInstance().publishRates(std::move(snapshot));
+    }
+
+    QJsonArray results;
+    benchConversions(settings, results);
+    benchLookups(settings, results);
+    benchCatalog(settings, results);
+    benchSearch(settings, results);
+    benchPopulate(settings, results);
+    benchIngestion(settings, results);
+    benchMetrics(settings, results);
+
+    QJsonObject root;
+    root["benchmark"] = "converter_bench";
+    root["timestamp"] = QDateTime::currentDateTimeUtc().toString(Qt::ISODate);
+    root["cpu_arch"] = QSysInfo::currentCpuArchitecture();
+    root["kernel_isa"] = ConversionKernels::isaName(ConversionKernels::activeIsa());
+    root["threads"] = static_cast<int>(WorkStealingPool::global().threadCount());
+    root["repeats"] = settings.repeats;
+    root["results"] = results;
+
+    const QByteArray json = QJsonDocument(root).toJson(QJsonDocument::Indented);
+    if (outputPath.isEmpty()) {
+        std::fwrite(json.constData(), 1, static_cast<std::size_t>(json.size()), stdout);
+        return 0;
+    }
+
+    QFile file(outputPath);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        std::fprintf(stderr, "converter_bench: cannot write %s\n", qPrintable(outputPath));
+        return 1;
+    }
+    file.write(json);
+    return 0;
+}
@@ -0,0 +1,296 @@
+// Load generator for convertserver.
+//
+//     http_loadgen [--host ADDR] [--port N] [--threads N] [--connections N]
+//                  [--pipeline N] [--warmup S] [--duration S] [--batch N]
+//                  [--path PATH]
+//
+// Opens --connections keep-alive connections spread over --threads event
+// loops and keeps --pipeline requests in flight on each. Every response is
+// matched to its request in order to record latency. Nothing is counted
+// during --warmup, so connection setup and cold caches stay out of the
+// figures; throughput, status counts and latency percentiles cover the
+// --duration that follows.
+//
+// Default request: GET /convert?from=Miles&to=Kilometers&value=42.
+// With --batch N each request is a POST /convert/batch of N values.
+
+#include "tools/toolsupport.h"
+#include "unitmetrics.h"
+
+#include <QCoreApplication>
+#include <QEventLoop>
+#include <QTcpSocket>
+#include <QThread>
+#include <QTimer>
+
+#include <algorithm>
+#include <chrono>
+#include <charconv>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Batches and durations may go past ToolSupport::parseCount's default cap
+constexpr long MaxOption = 1 << 24;
+
+struct Options {
+    QString host = "127.0.0.1";
+    quint16 port = 8080;
+    int threads = 4;
+    int connections = 64;
+    int pipeline = 16;
+    int warmupSeconds = 1;
+    int durationSeconds = 10;
+    int batch = 0;              // 0 = single GET conversions
+    QByteArray path = "/convert?from=Miles&to=Kilometers&value=42";
+};
+
+struct Stats {
+    std::uint64_t responses = 0;
+    std::uint64_t ok = 0;           // 2xx
+    std::uint64_t busy = 0;         // 503
+    std::uint64_t failed = 0;       // any other status
+    std::uint64_t socketErrors = 0;
+    double seconds = 0.0;           // measured window
+    UnitMetrics::Histogram latency;
+
+    void merge(const Stats &o) {
+        seconds = std::max(seconds, o.seconds);
+        responses += o.responses;
+        ok += o.ok;
+        busy += o.busy;
+        failed += o.failed;
+        socketErrors += o.socketErrors;
+        for (std::size_t i = 0; i < latency.buckets.size(); ++i)
+            latency.buckets[i] += o.latency.buckets[i];
+    }
+};
+
+void printUsage()
+{
+    std::fputs(
+        "usage: http_loadgen [options]\n"
+        "\n"
+        "  -h, --host ADDR        server address (default 127.0.0.1)\n"
+        "  -p, --port N           server port (default 8080)\n"
+        "  -t, --threads N        client event loops (default 4)\n"
+        "  -c, --connections N    keep-alive connections in total (default 64)\n"
+        "  -P, --pipeline N       requests in flight per connection (default 16)\n"
+        "  -w, --warmup S         seconds to run before counting (default 1)\n"
+        "  -d, --duration S       seconds to count (default 10)\n"
+        "  -b, --batch N          POST /convert/batch with N values per request\n"
+        "      --path PATH        GET target for single conversions\n",
+        stderr);
+}
+
+QByteArray buildRequest(const Options &opts)
+{
+    const QByteArray host = opts.host.toUtf8();
+    if (opts.batch <= 0)
+        return "GET " + opts.path + " HTTP/1.1\r\nHost: " + host + "\r\n\r\n";
+
+    QByteArray body = "{\"from\":\"Miles\",\"to\":\"Kilometers\",\"values\":[";
+    for (int i = 0; i < opts.batch; ++i) {
+        if (i) body.append(',');
+        body.append(QByteArray::number(i % 1000) + ".5");
+    }
+    body.append("]}");
+    return "POST /convert/batch HTTP/1.1\r\nHost: " + host
+         + "\r\nContent-Type: application/json\r\nContent-Length: " + QByteArray::number(body.size())
+         + "\r\n\r\n" + body;
+}
+
+/* ===================== CLIENT CONNECTION ===================== */
+
+// One keep-alive connection with a fixed number of requests in flight
+class LoadConnection
+{
+public:
+    LoadConnection(const Options &opts, const QByteArray &request, Stats &stats, const bool &running)
+        : opts(opts), request(request), stats(stats), running(running)
+    {
+        socket.setSocketOption(QAbstractSocket::LowDelayOption, 1);
+        QObject::connect(&socket, &QTcpSocket::connected, [this] { fill(); });
+        QObject::connect(&socket, &QTcpSocket::readyRead, [this] { onReadyRead(); });
+        QObject::connect(&socket, &QTcpSocket::errorOccurred, [this](QAbstractSocket::SocketError error) {
+            if (error != QAbstractSocket::RemoteHostClosedError) ++this->stats.socketErrors;
+        });
+        QObject::connect(&socket, &QTcpSocket::disconnected, [this] { reconnect(); });
+    }
+
+    ~LoadConnection() { QObject::disconnect(&socket, nullptr, nullptr, nullptr); }
+
+    void start() { socket.connectToHost(opts.host, opts.port); }
+
+private:
+    void fill()
+    {
+        QByteArray out;
+        const auto now = Clock::now();
+        while (running && static_cast<int>(sentAt.size()) < opts.pipeline) {
+            out.append(request);
+            sentAt.push_back(now);
+        }
+        if (!out.isEmpty()) socket.write(out);
+    }
+
+    // Consumes every complete response, then tops the pipeline back up.
+    // Only as much HTTP as convertserver emits is understood.
+    void onReadyRead()
+    {
+        in.append(socket.readAll());
+        std::string_view pending(in.constData(), static_cast<std::size_t>(in.size()));
+        std::size_t consumed = 0;
+
+        for (;;) {
+            const std::string_view rest = pending.substr(consumed);
+            const std::size_t headerEnd = rest.find("\r\n\r\n");
+            if (headerEnd == std::string_view::npos || rest.size() < 12) break;
+
+            int status = 0;
+            std::from_chars(rest.data() + 9, rest.data() + 12, status);
+            std::size_t length = 0;
+            const std::size_t field = rest.substr(0, headerEnd).find("Content-Length: ");
+            if (field != std::string_view::npos)
+                std::from_chars(rest.data() + field + 16, rest.data() + headerEnd, length);
+            if (rest.size() < headerEnd + 4 + length) break;
+            consumed += headerEnd + 4 + length;
+
+            if (status == 100) continue;
+            record(status);
+        }
+
+        in.remove(0, static_cast<qsizetype>(consumed));
+        fill();
+    }
+
+    void record(int status)
+    {
+        if (sentAt.empty()) return;
+        const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - sentAt.front()).count();
+        sentAt.pop_front();
+
+        ++stats.responses;
+        if (status >= 200 && status < 300) ++stats.ok;
+        else if (status == 503) ++stats.busy;
+        else ++stats.failed;
+        stats.latency.buckets[UnitMetrics::Histogram::bucketFor(static_cast<std::uint64_t>(ns))] += 1;
+    }
+
+    // The server closes on 503 and idle timeouts; open a fresh connection
+    void reconnect()
+    {
+        in.clear();
+        sentAt.clear();
+        if (running) QTimer::singleShot(0, &socket, [this] { start(); });
+    }
+
+    const Options &opts;
+    const QByteArray &request;
+    Stats &stats;
+    const bool &running;
+
+    QTcpSocket socket;
+    QByteArray in;
+    std::deque<Clock::time_point> sentAt;
+};
+
+// Runs `connections` clients on the calling thread's event loop
+void runClients(const Options &opts, int connections, Stats &stats)
+{
+    const QByteArray request = buildRequest(opts);
+    bool running = true;
+
+    std::vector<std::unique_ptr<LoadConnection>> clients;
+    for (int i = 0; i < connections; ++i) {
+        clients.push_back(std::make_unique<LoadConnection>(opts, request, stats, running));
+        clients.back()->start();
+    }
+
+    QEventLoop loop;
+    auto measuredFrom = Clock::now();
+    QTimer::singleShot(opts.warmupSeconds * 1000, &loop, [&] {
+        stats = Stats();
+        measuredFrom = Clock::now();
+    });
+    QTimer::singleShot((opts.warmupSeconds + opts.durationSeconds) * 1000, &loop, [&] {
+        running = false;
+        stats.seconds = std::chrono::duration<double>(Clock::now() - measuredFrom).count();
+        loop.quit();
+    });
+    loop.exec();
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    Options opts;
+    for (int i = 1; i < argc; ++i) {
+        const char *arg = argv[i];
+        const char *value = i + 1 < argc ? argv[i + 1] : nullptr;
+        int n = 0;
+        auto is = [arg](const char *longName, const char *shortName) {
+            return !std::strcmp(arg, longName) || (shortName && !std::strcmp(arg, shortName));
+        };
+
+        if (!value) {
+            printUsage();
+            return 2;
+        }
+        if (is("--host", "-h")) opts.host = QString::fromLocal8Bit(value);
+        else if (is("--port", "-p") && ToolSupport::parseCount(value, n, MaxOption) && n < 65536) opts.port = static_cast<quint16>(n);
+        else if (is("--threads", "-t") && ToolSupport::parseCount(value, n, MaxOption)) opts.threads = n;
+        else if (is("--connections", "-c") && ToolSupport::parseCount(value, n, MaxOption)) opts.connections = n;
+        else if (is("--pipeline", "-P") && ToolSupport::parseCount(value, n, MaxOption)) opts.pipeline = n;
+        else if (is("--warmup", "-w") && (!std::strcmp(value, "0") || ToolSupport::parseCount(value, n, MaxOption))) opts.warmupSeconds = n;
+        else if (is("--duration", "-d") && ToolSupport::parseCount(value, n, MaxOption)) opts.durationSeconds = n;
+        else if (is("--batch", "-b") && ToolSupport::parseCount(value, n, MaxOption)) opts.batch = n;
+        else if (is("--path", nullptr)) opts.path = value;
+        else {
+            printUsage();
+            return 2;
+        }
+        ++i;
+    }
+    opts.threads = std::min(opts.threads, opts.connections);
+
+    std::vector<Stats> perThread(static_cast<std::size_t>(opts.threads));
+    std::vector<std::unique_ptr<QThread>> threads;
+    for (int t = 0; t < opts.threads; ++t) {
+        // Deal connections out as evenly as possible
+        const int connections = opts.connections / opts.threads + (t < opts.connections % opts.threads ? 1 : 0);
+        Stats &stats = perThread[static_cast<std::size_t>(t)];
+        threads.emplace_back(QThread::create([&opts, connections, &stats] { runClients(opts, connections, stats); }));
+        threads.back()->start();
+    }
+    for (auto &thread : threads) thread->wait();
+
+    Stats total;
+    for (const Stats &s : perThread) total.merge(s);
+
+    const double seconds = total.seconds;
+    const double perSecond = seconds > 0.0 ? static_cast<double>(total.responses) / seconds : 0.0;
+    std::printf("connections   %d on %d threads, pipeline %d\n", opts.connections, opts.threads, opts.pipeline);
+    std::printf("requests      %llu in %.2f s after %d s warm-up\n",
+                static_cast<unsigned long long>(total.responses), seconds, opts.warmupSeconds);
+    std::printf("throughput    %.0f req/s", perSecond);
+    if (opts.batch > 0) std::printf(" (%.0f values/s)", perSecond * opts.batch);
+    std::printf("\n");
+    std::printf("status        2xx %llu, 503 %llu, other %llu, socket errors %llu\n",
+                static_cast<unsigned long long>(total.ok), static_cast<unsigned long long>(total.busy),
+                static_cast<unsigned long long>(total.failed), static_cast<unsigned long long>(total.socketErrors));
+    std::printf("latency       p50 %.1f us, p90 %.1f us, p99 %.1f us, p99.9 %.1f us\n",
+                total.latency.percentile(0.50) / 1e3, total.latency.percentile(0.90) / 1e3,
+                total.latency.percentile(0.99) / 1e3, total.latency.percentile(0.999) / 1e3);
+    return total.ok > 0 ? 0 : 1;
+}
@@ -0,0 +1,78 @@
+// Scaling benchmark for ConversionPlan's parallel batch mode.
+//
+//     converter_parallel_bench [elements] [max-threads]
+//
+// Converts one large array with 1..max-threads pools and prints the
+// throughput and speedup over a single thread for each.
+
+#include "conversionplan.h"
+#include "quantity.h"
+#include "threadpool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+namespace {
+
+double bestSeconds(const ConversionPlan &plan, const std::vector<double> &in,
+                   std::vector<double> &out, WorkStealingPool &pool, int repeats) {
+    double best = 1e300;
+    for (int r = 0; r < repeats; ++r) {
+        const auto start = std::chrono::steady_clock::now();
+        plan.apply(in, out, pool);
+        const auto stop = std::chrono::steady_clock::now();
+        best = std::min(best, std::chrono::duration<double>(stop - start).count());
+    }
+    return best;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    const std::size_t elements = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : (std::size_t(1) << 26);
+    const unsigned maxThreads = argc > 2 ? static_cast<unsigned>(std::strtoul(argv[2], nullptr, 10))
+                                         : std::max(1u, std::thread::hardware_concurrency());
+
+    using namespace Quantities;
+    const ConversionPlan plan = ConversionPlan::affine(scaleFactor<Miles, Feet>);
+
+    std::vector<double> in(elements);
+    for (std::size_t i = 0; i < elements; ++i)
+        in[i] = static_cast<double>(i % 1000) * 0.5;
+    std::vector<double> out(elements);
+    std::vector<double> reference(elements);
+    plan.apply(in, reference);
+
+    const double bytes = static_cast<double>(elements) * sizeof(double) * 2;
+    std::printf("elements=%zu  chunk=%zu\n", elements, ConversionPlan::DefaultParallelChunk);
+    std::printf("%8s %12s %10s %9s\n", "threads", "seconds", "GB/s", "speedup");
+
+    // 1, 2, 4, ... plus the requested maximum
+    std::vector<unsigned> counts;
+    for (unsigned t = 1; t < maxThreads; t *= 2)
+        counts.push_back(t);
+    counts.push_back(maxThreads);
+
+    double baseline = 0.0;
+    for (unsigned threads : counts) {
+        WorkStealingPool pool(threads);
+        plan.apply(in, out, pool); // warm up pages and threads
+
+        const double seconds = bestSeconds(plan, in, out, pool, 5);
+        if (threads == 1) baseline = seconds;
+
+        if (std::memcmp(out.data(), reference.data(), elements * sizeof(double)) != 0) {
+            std::fprintf(stderr, "output mismatch at %u threads\n", threads);
+            return 1;
+        }
+
+        std::printf("%8u %12.6f %10.2f %9.2f\n", threads, seconds, bytes / seconds / 1e9, baseline / seconds);
+    }
+    return 0;
+}
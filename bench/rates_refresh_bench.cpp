@@ -0,0 +1,104 @@
+// Cost of one currency-rate refresh, end to end through RatesFetcher.
+//
+//     rates_refresh_bench [--endpoint URL[,URL...]] [--refreshes N]
+//
+// Point it at mockrates (or any providers, in preference order) and it
+// runs N refreshes back to back, reporting how many published new rates,
+// came back unchanged (304 or identical rates) or failed, which provider
+// answered, and wall time, latency percentiles and process CPU time per
+// refresh. Wire bytes per response are logged by mockrates. Run several
+// mockrates with --delay/--fail-rate to exercise hedging and failover.
+
+#include "ratesfetcher.h"
+#include "unitmetrics.h"
+
+#include <QCoreApplication>
+#include <QMap>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    RatesFetcher::Settings settings;
+    settings.providers = RatesFetcher::providersFromString(
+        qEnvironmentVariable("RATES_ENDPOINTS", "http://127.0.0.1:8090/latest"));
+    settings.refreshIntervalSeconds = 24 * 3600;    // refreshes are driven below
+    int refreshes = 100;
+
+    for (int i = 1; i < argc; ++i) {
+        if (!std::strcmp(argv[i], "--endpoint") && i + 1 < argc) {
+            settings.providers = RatesFetcher::providersFromString(QString::fromLocal8Bit(argv[++i]));
+        } else if (!std::strcmp(argv[i], "--refreshes") && i + 1 < argc && std::atoi(argv[i + 1]) > 0) {
+            refreshes = std::atoi(argv[++i]);
+        } else {
+            std::fputs("usage: rates_refresh_bench [--endpoint URL[,URL...]] [--refreshes N]\n", stderr);
+            return 2;
+        }
+    }
+
+    RatesFetcher fetcher(settings);
+    int published = 0, unchanged = 0, failed = 0;
+    QMap<QString, int> wins;
+    UnitMetrics::Histogram latency;
+
+    // The first fetch comes from start() and primes the validators; it is
+    // not counted
+    bool primed = false;
+    std::clock_t cpuStart = 0;
+    std::chrono::steady_clock::time_point wallStart, refreshStart;
+
+    auto next = [&]() {
+        const auto now = std::chrono::steady_clock::now();
+        if (!primed) {
+            primed = true;
+            cpuStart = std::clock();
+            wallStart = now;
+        } else {
+            const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(now - refreshStart).count();
+            latency.buckets[UnitMetrics::Histogram::bucketFor(static_cast<std::uint64_t>(ns))] += 1;
+            if (published + unchanged + failed == refreshes) {
+                app.quit();
+                return;
+            }
+        }
+        refreshStart = std::chrono::steady_clock::now();
+        QMetaObject::invokeMethod(&fetcher, &RatesFetcher::fetchRates, Qt::QueuedConnection);
+    };
+    QObject::connect(&fetcher, &RatesFetcher::ratesPublished, [&](quint64, int, int, const QString &provider) {
+        if (primed) { ++published; ++wins[provider]; }
+        next();
+    });
+    QObject::connect(&fetcher, &RatesFetcher::ratesUnchanged, [&](const QString &provider) {
+        if (primed) { ++unchanged; ++wins[provider]; }
+        next();
+    });
+    QObject::connect(&fetcher, &RatesFetcher::fetchFailed, [&]() {
+        if (!primed) {
+            std::fputs("rates_refresh_bench: first fetch failed\n", stderr);
+            app.exit(1);
+            return;
+        }
+        ++failed;
+        next();
+    });
+
+    fetcher.start();
+    const int rc = app.exec();
+    if (rc != 0) return rc;
+
+    const double cpu = static_cast<double>(std::clock() - cpuStart) / CLOCKS_PER_SEC;
+    const double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+    std::printf("refreshes    %d (published %d, unchanged %d, failed %d)\n", refreshes, published, unchanged, failed);
+    for (auto it = wins.cbegin(); it != wins.cend(); ++it)
+        std::printf("  answered   %d by %s\n", it.value(), it.key().toLocal8Bit().constData());
+    std::printf("wall         %.1f us/refresh, p50 %.2f ms, p99 %.2f ms\n", wall / refreshes * 1e6,
+                latency.percentile(0.50) / 1e6, latency.percentile(0.99) / 1e6);
+    std::printf("cpu          %.1f us/refresh (process, all threads)\n", cpu / refreshes * 1e6);
+    return 0;
+}
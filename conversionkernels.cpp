@@ -0,0 +1,229 @@
+#include "conversionkernels.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define CONVERTER_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+// GCC/Clang need a per-function target to emit wider instructions than
+// the baseline; MSVC always accepts the intrinsics.
+#if defined(__GNUC__) || defined(__clang__)
+#define KERNEL_TARGET(isa) __attribute__((target(isa)))
+#else
+#define KERNEL_TARGET(isa)
+#endif
+
+namespace ConversionKernels {
+
+/* ===================== CPU DETECTION ===================== */
+
+namespace {
+
+Isa detectIsa() {
+#if defined(CONVERTER_X86)
+#if defined(_MSC_VER)
+    int regs[4];
+    __cpuid(regs, 0);
+    const int maxLeaf = regs[0];
+
+    __cpuid(regs, 1);
+    const bool sse2 = (regs[3] & (1 << 26)) != 0;
+    const bool osxsave = (regs[2] & (1 << 27)) != 0;
+    const bool avx = (regs[2] & (1 << 28)) != 0;
+
+    // The OS must save the wider registers on context switch
+    const unsigned long long xcr0 = osxsave ? _xgetbv(0) : 0;
+    const bool ymmState = (xcr0 & 0x6) == 0x6;
+    const bool zmmState = (xcr0 & 0xE6) == 0xE6;
+
+    bool avx2 = false;
+    bool avx512f = false;
+    if (maxLeaf >= 7) {
+        __cpuidex(regs, 7, 0);
+        avx2 = (regs[1] & (1 << 5)) != 0;
+        avx512f = (regs[1] & (1 << 16)) != 0;
+    }
+
+    if (avx512f && zmmState) return Isa::AVX512;
+    if (avx2 && avx && ymmState) return Isa::AVX2;
+    if (sse2) return Isa::SSE2;
+#else
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) return Isa::AVX512;
+    if (__builtin_cpu_supports("avx2")) return Isa::AVX2;
+    if (__builtin_cpu_supports("sse2")) return Isa::SSE2;
+#endif
+#endif
+    return Isa::Scalar;
+}
+
+/* ===================== SCALE KERNELS ===================== */
+
+void scaleScalar(const double *in, double *out, std::size_t count, double factor) {
+    for (std::size_t i = 0; i < count; ++i)
+        out[i] = in[i] * factor;
+}
+
+#if defined(CONVERTER_X86)
+KERNEL_TARGET("sse2")
+void scaleSse2(const double *in, double *out, std::size_t count, double factor) {
+    const __m128d k = _mm_set1_pd(factor);
+    std::size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128d a = _mm_loadu_pd(in + i);
+        __m128d b = _mm_loadu_pd(in + i + 2);
+        _mm_storeu_pd(out + i, _mm_mul_pd(a, k));
+        _mm_storeu_pd(out + i + 2, _mm_mul_pd(b, k));
+    }
+    scaleScalar(in + i, out + i, count - i, factor);
+}
+
+KERNEL_TARGET("avx2")
+void scaleAvx2(const double *in, double *out, std::size_t count, double factor) {
+    const __m256d k = _mm256_set1_pd(factor);
+    std::size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256d a = _mm256_loadu_pd(in + i);
+        __m256d b = _mm256_loadu_pd(in + i + 4);
+        _mm256_storeu_pd(out + i, _mm256_mul_pd(a, k));
+        _mm256_storeu_pd(out + i + 4, _mm256_mul_pd(b, k));
+    }
+    scaleScalar(in + i, out + i, count - i, factor);
+}
+
+KERNEL_TARGET("avx512f")
+void scaleAvx512(const double *in, double *out, std::size_t count, double factor) {
+    const __m512d k = _mm512_set1_pd(factor);
+    std::size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m512d a = _mm512_loadu_pd(in + i);
+        __m512d b = _mm512_loadu_pd(in + i + 8);
+        _mm512_storeu_pd(out + i, _mm512_mul_pd(a, k));
+        _mm512_storeu_pd(out + i + 8, _mm512_mul_pd(b, k));
+    }
+    scaleScalar(in + i, out + i, count - i, factor);
+}
+#endif
+
+/* ===================== AFFINE KERNELS ===================== */
+
+void affineScalar(const double *in, double *out, std::size_t count, double factor, double offset) {
+    for (std::size_t i = 0; i < count; ++i)
+        out[i] = in[i] * factor + offset;
+}
+
+#if defined(CONVERTER_X86)
+KERNEL_TARGET("sse2")
+void affineSse2(const double *in, double *out, std::size_t count, double factor, double offset) {
+    const __m128d k = _mm_set1_pd(factor);
+    const __m128d c = _mm_set1_pd(offset);
+    std::size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128d a = _mm_loadu_pd(in + i);
+        __m128d b = _mm_loadu_pd(in + i + 2);
+        _mm_storeu_pd(out + i, _mm_add_pd(_mm_mul_pd(a, k), c));
+        _mm_storeu_pd(out + i + 2, _mm_add_pd(_mm_mul_pd(b, k), c));
+    }
+    affineScalar(in + i, out + i, count - i, factor, offset);
+}
+
+KERNEL_TARGET("avx2")
+void affineAvx2(const double *in, double *out, std::size_t count, double factor, double offset) {
+    const __m256d k = _mm256_set1_pd(factor);
+    const __m256d c = _mm256_set1_pd(offset);
+    std::size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256d a = _mm256_loadu_pd(in + i);
+        __m256d b = _mm256_loadu_pd(in + i + 4);
+        _mm256_storeu_pd(out + i, _mm256_add_pd(_mm256_mul_pd(a, k), c));
+        _mm256_storeu_pd(out + i + 4, _mm256_add_pd(_mm256_mul_pd(b, k), c));
+    }
+    affineScalar(in + i, out + i, count - i, factor, offset);
+}
+
+KERNEL_TARGET("avx512f")
+void affineAvx512(const double *in, double *out, std::size_t count, double factor, double offset) {
+    const __m512d k = _mm512_set1_pd(factor);
+    const __m512d c = _mm512_set1_pd(offset);
+    std::size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m512d a = _mm512_loadu_pd(in + i);
+        __m512d b = _mm512_loadu_pd(in + i + 8);
+        _mm512_storeu_pd(out + i, _mm512_add_pd(_mm512_mul_pd(a, k), c));
+        _mm512_storeu_pd(out + i + 8, _mm512_add_pd(_mm512_mul_pd(b, k), c));
+    }
+    affineScalar(in + i, out + i, count - i, factor, offset);
+}
+#endif
+
+using ScaleFn = void (*)(const double *, double *, std::size_t, double);
+using AffineFn = void (*)(const double *, double *, std::size_t, double, double);
+
+ScaleFn selectScale(Isa isa) {
+    switch (isa) {
+#if defined(CONVERTER_X86)
+    case Isa::AVX512: return scaleAvx512;
+    case Isa::AVX2:   return scaleAvx2;
+    case Isa::SSE2:   return scaleSse2;
+#endif
+    default:          return scaleScalar;
+    }
+}
+
+AffineFn selectAffine(Isa isa) {
+    switch (isa) {
+#if defined(CONVERTER_X86)
+    case Isa::AVX512: return affineAvx512;
+    case Isa::AVX2:   return affineAvx2;
+    case Isa::SSE2:   return affineSse2;
+#endif
+    default:          return affineScalar;
+    }
+}
+
+} // namespace
+
+/* ===================== DISPATCH ===================== */
+
+Isa activeIsa() {
+    static const Isa isa = detectIsa();
+    return isa;
+}
+
+const char *isaName(Isa isa) {
+    switch (isa) {
+    case Isa::AVX512: return "avx512";
+    case Isa::AVX2:   return "avx2";
+    case Isa::SSE2:   return "sse2";
+    case Isa::Scalar: return "scalar";
+    }
+    return "scalar";
+}
+
+void scale(const double *in, double *out, std::size_t count, double factor) {
+    static const ScaleFn fn = selectScale(activeIsa());
+    fn(in, out, count, factor);
+}
+
+void affine(const double *in, double *out, std::size_t count, double factor, double offset) {
+    static const AffineFn fn = selectAffine(activeIsa());
+    fn(in, out, count, factor, offset);
+}
+
+// Isa is ordered narrowest to widest, and each level implies the ones below
+bool isSupported(Isa isa) {
+    return isa <= activeIsa();
+}
+
+void scale(Isa isa, const double *in, double *out, std::size_t count, double factor) {
+    selectScale(isa)(in, out, count, factor);
+}
+
+void affine(Isa isa, const double *in, double *out, std::size_t count, double factor, double offset) {
+    selectAffine(isa)(in, out, count, factor, offset);
+}
+
+} // namespace ConversionKernels
@@ -0,0 +1,32 @@
+#ifndef CONVERSIONKERNELS_H
+#define CONVERSIONKERNELS_H
+
+#include <cstddef>
+
+// Vectorized array kernels behind Units::convertBatch. The widest
+// instruction set the CPU supports is picked once at runtime; every
+// variant performs the same IEEE operations as the scalar path, so
+// results are bit-identical whichever one runs.
+namespace ConversionKernels {
+
+enum class Isa { Scalar, SSE2, AVX2, AVX512 };
+
+Isa activeIsa();
+const char *isaName(Isa isa);
+
+// out[i] = in[i] * factor. `in` and `out` may be the same array.
+void scale(const double *in, double *out, std::size_t count, double factor);
+
+// out[i] = in[i] * factor + offset, as a separate multiply and add (never
+// fused) so it rounds exactly like ConversionPlan::apply.
+void affine(const double *in, double *out, std::size_t count, double factor, double offset);
+
+// The same kernels pinned to one instruction set, so tests can check every
+// variant this CPU can run against the scalar one. `isa` must be supported.
+bool isSupported(Isa isa);
+void scale(Isa isa, const double *in, double *out, std::size_t count, double factor);
+void affine(Isa isa, const double *in, double *out, std::size_t count, double factor, double offset);
+
+} // namespace ConversionKernels
+
+#endif // CONVERSIONKERNELS_H
@@ -0,0 +1,71 @@
+#include "conversionplan.h"
+#include "conversionkernels.h"
+#include "threadpool.h"
+
+#include <algorithm>
+#include <cstring>
+
+void ConversionPlan::apply(std::span<const double> in, std::span<double> out) const {
+    const std::size_t count = std::min(in.size(), out.size());
+    if (count == 0) return;
+
+    if (!valid || isIdentity()) {
+        if (in.data() != out.data())
+            std::memmove(out.data(), in.data(), count * sizeof(double));
+        return;
+    }
+
+    if (shift == 0.0)
+        ConversionKernels::scale(in.data(), out.data(), count, factor);
+    else
+        ConversionKernels::affine(in.data(), out.data(), count, factor, shift);
+}
+
+void ConversionPlan::apply(std::span<const double> in, std::span<double> out,
+                           WorkStealingPool &pool, std::size_t chunkSize) const {
+    const std::size_t count = std::min(in.size(), out.size());
+    if (count <= chunkSize) {
+        apply(in, out);
+        return;
+    }
+
+    // Every element is independent, so chunking never changes the output
+    pool.parallelFor(count, chunkSize, [&](std::size_t begin, std::size_t end) {
+        apply(in.subspan(begin, end - begin), out.subspan(begin, end - begin));
+    });
+}
+
+void ConversionPlan::apply(std::span<const float> in, std::span<float> out) const {
+    const std::size_t count = std::min(in.size(), out.size());
+    if (count == 0) return;
+
+    if (!valid || isIdentity()) {
+        if (in.data() != out.data())
+            std::memmove(out.data(), in.data(), count * sizeof(float));
+        return;
+    }
+
+    // Simple enough for the compiler to vectorise on its own
+    const double k = factor;
+    const double c = shift;
+    if (c == 0.0) {
+        for (std::size_t i = 0; i < count; ++i)
+            out[i] = static_cast<float>(static_cast<double>(in[i]) * k);
+    } else {
+        for (std::size_t i = 0; i < count; ++i)
+            out[i] = static_cast<float>(static_cast<double>(in[i]) * k + c);
+    }
+}
+
+void ConversionPlan::apply(std::span<const float> in, std::span<float> out,
+                           WorkStealingPool &pool, std::size_t chunkSize) const {
+    const std::size_t count = std::min(in.size(), out.size());
+    if (count <= chunkSize) {
+        apply(in, out);
+        return;
+    }
+
+    pool.parallelFor(count, chunkSize, [&](std::size_t begin, std::size_t end) {
+        apply(in.subspan(begin, end - begin), out.subspan(begin, end - begin));
+    });
+}
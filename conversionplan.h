@@ -0,0 +1,74 @@
+#ifndef CONVERSIONPLAN_H
+#define CONVERSIONPLAN_H
+
+#include <cstddef>
+#include <span>
+
+class WorkStealingPool;
+
+// A resolved conversion between two units: out = in * scale + offset.
+//
+// Plans are immutable values. Build one with Units::plan(), then reuse it
+// for as many scalar or batch conversions as needed; nothing is looked up
+// again. Chained conversions fuse into a single plan with then().
+//
+// An invalid plan (unknown units, mismatched categories, missing currency
+// rate) passes values through unchanged, like Units::convert does.
+class ConversionPlan
+{
+public:
+    constexpr ConversionPlan() = default;
+
+    static constexpr ConversionPlan affine(double scale, double offset = 0.0) {
+        return ConversionPlan(scale, offset, true);
+    }
+    static constexpr ConversionPlan invalid() {
+        return ConversionPlan(1.0, 0.0, false);
+    }
+
+    constexpr bool isValid() const { return valid; }
+    constexpr bool isIdentity() const { return factor == 1.0 && shift == 0.0; }
+    constexpr double scale() const { return factor; }
+    constexpr double offset() const { return shift; }
+
+    // Pure scales skip the add so -0.0 and the rounding match a plain multiply
+    constexpr double apply(double value) const {
+        return shift == 0.0 ? value * factor : value * factor + shift;
+    }
+
+    // Applies the plan to min(in.size(), out.size()) values. `in` and `out`
+    // may alias. Bit-identical to calling apply() per element.
+    void apply(std::span<const double> in, std::span<double> out) const;
+
+    // Chunk size for the parallel overload: 32k doubles, 256 KiB of input,
+    // keeps each chunk's input and output within a typical L2
+    static constexpr std::size_t DefaultParallelChunk = 32 * 1024;
+
+    // Same result as apply(in, out), split into chunks run on `pool`.
+    // Arrays of a single chunk or less run inline on the caller.
+    void apply(std::span<const double> in, std::span<double> out,
+               WorkStealingPool &pool, std::size_t chunkSize = DefaultParallelChunk) const;
+
+    // Single-precision arrays are widened, converted in double precision
+    // and rounded back, i.e. float(apply(double(x))) per element.
+    void apply(std::span<const float> in, std::span<float> out) const;
+    void apply(std::span<const float> in, std::span<float> out,
+               WorkStealingPool &pool, std::size_t chunkSize = DefaultParallelChunk) const;
+
+    // This plan followed by `next`, fused into one affine op
+    constexpr ConversionPlan then(const ConversionPlan &next) const {
+        return ConversionPlan(factor * next.factor,
+                              shift * next.factor + next.shift,
+                              valid && next.valid);
+    }
+
+private:
+    constexpr ConversionPlan(double scale, double offset, bool isValid)
+        : factor(scale), shift(offset), valid(isValid) {}
+
+    double factor = 1.0;
+    double shift = 0.0;
+    bool valid = true;
+};
+
+#endif // CONVERSIONPLAN_H
@@ -0,0 +1,487 @@
+#include "conversionserver.h"
+#include "httpparser.h"
+#include "unitcatalog.h"
+#include "units.h"
+
+#include <QElapsedTimer>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTcpSocket>
+#include <QTimer>
+#include <QUrlQuery>
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <memory>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+using HttpParser::ParseResult;
+using HttpParser::Request;
+
+/* ===================== RESPONSES ===================== */
+
+struct Reply {
+    int status = 200;
+    QByteArray body;
+};
+
+const char *reasonPhrase(int status)
+{
+    switch (status) {
+    case 200: return "OK";
+    case 400: return "Bad Request";
+    case 404: return "Not Found";
+    case 405: return "Method Not Allowed";
+    case 413: return "Content Too Large";
+    case 422: return "Unprocessable Content";
+    case 431: return "Request Header Fields Too Large";
+    case 501: return "Not Implemented";
+    case 503: return "Service Unavailable";
+    case 505: return "HTTP Version Not Supported";
+    }
+    return "Error";
+}
+
+void appendInteger(QByteArray &out, long long value)
+{
+    char digits[24];
+    const auto r = std::to_chars(digits, digits + sizeof(digits), value);
+    out.append(digits, r.ptr - digits);
+}
+
+// Shortest round-trip form; JSON has no NaN/Infinity, so those become null
+void appendNumber(QByteArray &out, double value)
+{
+    if (!std::isfinite(value)) {
+        out.append("null");
+        return;
+    }
+    char digits[32];
+    const auto r = std::to_chars(digits, digits + sizeof(digits), value);
+    out.append(digits, r.ptr - digits);
+}
+
+void appendString(QByteArray &out, const QString &text)
+{
+    static const char hex[] = "0123456789abcdef";
+    out.append('"');
+    for (char c : text.toUtf8()) {
+        if (c == '"' || c == '\\') {
+            out.append('\\');
+            out.append(c);
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            out.append("\\u00");
+            out.append(hex[(c >> 4) & 0xF]);
+            out.append(hex[c & 0xF]);
+        } else {
+            out.append(c);
+        }
+    }
+    out.append('"');
+}
+
+void appendResponse(QByteArray &out, const Reply &reply, bool keepAlive)
+{
+    out.append("HTTP/1.1 ");
+    appendInteger(out, reply.status);
+    out.append(' ');
+    out.append(reasonPhrase(reply.status));
+    out.append("\r\nContent-Type: application/json\r\nContent-Length: ");
+    appendInteger(out, reply.body.size());
+    if (reply.status == 405)
+        out.append("\r\nAllow: GET, POST");
+    if (reply.status == 503)
+        out.append("\r\nRetry-After: 1");
+    out.append(keepAlive ? "\r\nConnection: keep-alive\r\n\r\n" : "\r\nConnection: close\r\n\r\n");
+    out.append(reply.body);
+}
+
+Reply errorReply(int status, const QString &message)
+{
+    Reply reply;
+    reply.status = status;
+    reply.body.append("{\"error\":");
+    appendString(reply.body, message);
+    reply.body.append('}');
+    return reply;
+}
+
+/* ===================== CONVERSION ENDPOINTS ===================== */
+
+// Name a reply echoes: the built-in name ("km": Kilometers) or the
+// catalogue's spelled-out one ("yd": yard); empty for an unknown unit
+QString replyName(const QString &name)
+{
+    const Units &units = Units::getInstance();
+    const UnitId id = units.unitId(name);
+    if (id != InvalidUnitId)
+        return units.unitName(id);
+
+    const UnitCatalog &catalog = UnitCatalog::builtin();
+    const CatalogId unit = catalog.find(QStringView(name));
+    if (unit == InvalidCatalogId)
+        return QString();
+    const std::string_view spelled = catalog.name(unit);
+    return QString::fromUtf8(spelled.data(), static_cast<qsizetype>(spelled.size()));
+}
+
+// Resolves both names to one plan through Units::plan, so every unit the
+// GUI and unitconv accept works here too. Fills `from` and `to` with the
+// names to echo, or `error` with the reply to send.
+bool resolvePlan(const QString &fromName, const QString &toName,
+                 QString &from, QString &to, ConversionPlan &plan, Reply &error)
+{
+    from = replyName(fromName);
+    to = replyName(toName);
+    if (from.isEmpty() || to.isEmpty()) {
+        error = errorReply(400, QString("unknown unit '%1'").arg(from.isEmpty() ? fromName : toName));
+        return false;
+    }
+
+    plan = Units::getInstance().plan(fromName, toName);
+    if (!plan.isValid()) {
+        error = errorReply(422, QString("cannot convert %1 to %2").arg(fromName, toName));
+        return false;
+    }
+    return true;
+}
+
+Reply convertOne(const QString &fromName, const QString &toName, double value)
+{
+    QString from, to;
+    ConversionPlan plan;
+    Reply reply;
+    if (!resolvePlan(fromName, toName, from, to, plan, reply))
+        return reply;
+
+    reply.body.reserve(96);
+    reply.body.append("{\"from\":");
+    appendString(reply.body, from);
+    reply.body.append(",\"to\":");
+    appendString(reply.body, to);
+    reply.body.append(",\"value\":");
+    appendNumber(reply.body, value);
+    reply.body.append(",\"result\":");
+    appendNumber(reply.body, plan.apply(value));
+    reply.body.append('}');
+    return reply;
+}
+
+Reply handleConvertQuery(std::string_view query)
+{
+    const QUrlQuery params(QString::fromUtf8(query.data(), static_cast<qsizetype>(query.size())));
+    const QString from = params.queryItemValue("from", QUrl::FullyDecoded);
+    const QString to = params.queryItemValue("to", QUrl::FullyDecoded);
+    bool ok = false;
+    const double value = params.queryItemValue("value").toDouble(&ok);
+    if (from.isEmpty() || to.isEmpty() || !ok || !std::isfinite(value))
+        return errorReply(400, "expected from, to and a numeric value");
+    return convertOne(from, to, value);
+}
+
+bool parseBody(std::string_view body, QJsonObject &object)
+{
+    QJsonParseError error;
+    const QJsonDocument doc = QJsonDocument::fromJson(
+        QByteArray::fromRawData(body.data(), static_cast<qsizetype>(body.size())), &error);
+    if (error.error != QJsonParseError::NoError || !doc.isObject())
+        return false;
+    object = doc.object();
+    return true;
+}
+
+Reply handleConvertBody(std::string_view body)
+{
+    QJsonObject object;
+    if (!parseBody(body, object))
+        return errorReply(400, "body must be a JSON object");
+
+    const QJsonValue value = object.value("value");
+    if (!value.isDouble())
+        return errorReply(400, "expected from, to and a numeric value");
+    return convertOne(object.value("from").toString(), object.value("to").toString(), value.toDouble());
+}
+
+Reply handleConvertBatch(std::string_view body, const ConversionServer::Limits &limits)
+{
+    QJsonObject object;
+    if (!parseBody(body, object))
+        return errorReply(400, "body must be a JSON object");
+
+    const QJsonValue valuesField = object.value("values");
+    if (!valuesField.isArray())
+        return errorReply(400, "expected from, to and a values array");
+
+    const QJsonArray values = valuesField.toArray();
+    if (values.size() > limits.maxBatchValues)
+        return errorReply(413, QString("at most %1 values per batch").arg(limits.maxBatchValues));
+
+    QString from, to;
+    ConversionPlan plan;
+    Reply reply;
+    if (!resolvePlan(object.value("from").toString(), object.value("to").toString(), from, to, plan, reply))
+        return reply;
+
+    std::vector<double> data(static_cast<std::size_t>(values.size()));
+    for (qsizetype i = 0; i < values.size(); ++i) {
+        const QJsonValue v = values.at(i);
+        if (!v.isDouble())
+            return errorReply(400, QString("values[%1] is not a number").arg(i));
+        data[static_cast<std::size_t>(i)] = v.toDouble();
+    }
+    plan.apply(data, data);
+
+    reply.body.reserve(64 + values.size() * 24);
+    reply.body.append("{\"from\":");
+    appendString(reply.body, from);
+    reply.body.append(",\"to\":");
+    appendString(reply.body, to);
+    reply.body.append(",\"results\":[");
+    for (std::size_t i = 0; i < data.size(); ++i) {
+        if (i) reply.body.append(',');
+        appendNumber(reply.body, data[i]);
+    }
+    reply.body.append("]}");
+    return reply;
+}
+
+Reply route(const Request &req, const ConversionServer::Limits &limits)
+{
+    const std::size_t q = req.target.find('?');
+    const std::string_view path = req.target.substr(0, q);
+    const std::string_view query = q == std::string_view::npos ? std::string_view() : req.target.substr(q + 1);
+
+    if (path == "/convert") {
+        if (req.method == "GET") return handleConvertQuery(query);
+        if (req.method == "POST") return handleConvertBody(req.body);
+        return errorReply(405, "use GET or POST");
+    }
+    if (path == "/convert/batch") {
+        if (req.method == "POST") return handleConvertBatch(req.body, limits);
+        return errorReply(405, "use POST");
+    }
+    return errorReply(404, "no such endpoint");
+}
+
+} // namespace
+
+/* ===================== WORKER ===================== */
+
+// Owns the connections handed to one thread. Lives on that thread; every
+// member is touched only from its event loop.
+class ServerWorker : public QObject
+{
+public:
+    ServerWorker(const ConversionServer::Limits &limits, std::atomic<int> &connections)
+        : limits(limits), connections(connections) {}
+
+    void start();
+    void adopt(qintptr socketDescriptor);
+
+private:
+    struct Connection {
+        QTcpSocket *socket = nullptr;
+        QByteArray in;
+        qsizetype parsed = 0;       // bytes of `in` already answered
+        qint64 lastActive = 0;      // clock.elapsed() of the last read
+        bool continueSent = false;
+        bool closing = false;
+    };
+
+    void service(Connection *c);
+    void drop(QTcpSocket *socket);
+    void sweepIdle();
+
+    const ConversionServer::Limits &limits;
+    std::atomic<int> &connections;
+    std::unordered_map<QTcpSocket *, std::unique_ptr<Connection>> open;
+    QElapsedTimer clock;
+    QTimer *idleTimer = nullptr;
+};
+
+void ServerWorker::start()
+{
+    clock.start();
+    idleTimer = new QTimer(this);
+    connect(idleTimer, &QTimer::timeout, this, [this] { sweepIdle(); });
+    idleTimer->start(std::max(250, limits.idleTimeoutMs / 4));
+}
+
+void ServerWorker::adopt(qintptr socketDescriptor)
+{
+    QTcpSocket *socket = new QTcpSocket(this);
+    if (!socket->setSocketDescriptor(socketDescriptor)) {
+        delete socket;
+        connections.fetch_sub(1, std::memory_order_relaxed);
+        return;
+    }
+    socket->setSocketOption(QAbstractSocket::LowDelayOption, 1);
+    socket->setReadBufferSize(limits.readBufferBytes);
+
+    auto c = std::make_unique<Connection>();
+    c->socket = socket;
+    c->lastActive = clock.elapsed();
+    Connection *conn = c.get();
+    open.emplace(socket, std::move(c));
+
+    connect(socket, &QTcpSocket::readyRead, this, [this, conn] { service(conn); });
+    connect(socket, &QTcpSocket::bytesWritten, this, [this, conn] { service(conn); });
+    connect(socket, &QTcpSocket::disconnected, this, [this, socket] { drop(socket); });
+}
+
+// Reads what the socket has and answers every complete request, stopping
+// while too many reply bytes are still unsent
+void ServerWorker::service(Connection *c)
+{
+    QTcpSocket *socket = c->socket;
+    if (c->closing || socket->bytesToWrite() > limits.writeHighWatermark)
+        return;
+
+    if (socket->bytesAvailable() > 0) {
+        c->in.append(socket->readAll());
+        c->lastActive = clock.elapsed();
+    }
+
+    const HttpParser::Limits parserLimits{static_cast<std::size_t>(limits.maxHeaderBytes),
+                                          static_cast<std::size_t>(limits.maxBodyBytes)};
+    QByteArray out;
+    while (!c->closing && socket->bytesToWrite() + out.size() <= limits.writeHighWatermark) {
+        const std::string_view pending(c->in.constData() + c->parsed,
+                                       static_cast<std::size_t>(c->in.size() - c->parsed));
+        if (pending.empty()) break;
+
+        Request req;
+        std::size_t consumed = 0;
+        int status = 0;
+        bool expectContinue = false;
+        const ParseResult result = HttpParser::parseRequest(pending, parserLimits, req, consumed, status,
+                                                            expectContinue);
+
+        if (result == ParseResult::Incomplete) {
+            if (expectContinue && !c->continueSent) {
+                out.append("HTTP/1.1 100 Continue\r\n\r\n");
+                c->continueSent = true;
+            }
+            break;
+        }
+        if (result == ParseResult::Error) {
+            appendResponse(out, errorReply(status, reasonPhrase(status)), false);
+            c->closing = true;
+            break;
+        }
+
+        appendResponse(out, route(req, limits), req.keepAlive);
+        c->parsed += static_cast<qsizetype>(consumed);
+        c->continueSent = false;
+        if (!req.keepAlive) c->closing = true;
+    }
+
+    // Keep the unanswered tail at the front; resize(0) keeps the capacity
+    if (c->parsed == c->in.size()) {
+        c->in.resize(0);
+        c->parsed = 0;
+    } else if (c->parsed > c->in.size() / 2) {
+        c->in.remove(0, c->parsed);
+        c->parsed = 0;
+    }
+
+    if (!out.isEmpty())
+        socket->write(out);
+    if (c->closing)
+        socket->disconnectFromHost();   // sends what is queued, then closes
+}
+
+void ServerWorker::drop(QTcpSocket *socket)
+{
+    if (open.erase(socket) == 0) return;
+    socket->disconnect(this);
+    socket->deleteLater();
+    connections.fetch_sub(1, std::memory_order_relaxed);
+}
+
+void ServerWorker::sweepIdle()
+{
+    const qint64 now = clock.elapsed();
+    std::vector<QTcpSocket *> idle;
+    for (const auto &[socket, c] : open) {
+        if (now - c->lastActive > limits.idleTimeoutMs && socket->bytesToWrite() == 0)
+            idle.push_back(socket);
+    }
+    for (QTcpSocket *socket : idle)
+        socket->abort();    // emits disconnected -> drop()
+}
+
+/* ===================== SERVER ===================== */
+
+ConversionServer::ConversionServer(QObject *parent)
+    : ConversionServer(Limits(), parent)
+{
+}
+
+ConversionServer::ConversionServer(const Limits &limits, QObject *parent)
+    : QTcpServer(parent), limits(limits)
+{
+    setListenBacklogSize(limits.listenBacklog);
+
+    const unsigned count = limits.workers ? limits.workers : std::max(1u, std::thread::hardware_concurrency());
+    for (unsigned i = 0; i < count; ++i) {
+        QThread *thread = new QThread(this);
+        thread->setObjectName(QString("convert-worker-%1").arg(i));
+        ServerWorker *worker = new ServerWorker(this->limits, connections);
+        worker->moveToThread(thread);
+        connect(thread, &QThread::finished, worker, &QObject::deleteLater);
+        thread->start();
+        QMetaObject::invokeMethod(worker, [worker] { worker->start(); }, Qt::QueuedConnection);
+
+        threads.push_back(thread);
+        workers.push_back(worker);
+    }
+}
+
+ConversionServer::~ConversionServer()
+{
+    close();
+    for (QThread *thread : threads) {
+        thread->quit();
+        thread->wait();
+    }
+}
+
+void ConversionServer::incomingConnection(qintptr socketDescriptor)
+{
+    if (connections.load(std::memory_order_relaxed) >= limits.maxConnections) {
+        reject(socketDescriptor);
+        return;
+    }
+    connections.fetch_add(1, std::memory_order_relaxed);
+
+    ServerWorker *worker = workers[nextWorker];
+    nextWorker = (nextWorker + 1) % workers.size();
+    QMetaObject::invokeMethod(worker, [worker, socketDescriptor] { worker->adopt(socketDescriptor); },
+                              Qt::QueuedConnection);
+}
+
+// Saturated: answer 503 right away so the client can back off and retry
+void ConversionServer::reject(qintptr socketDescriptor)
+{
+    rejected.fetch_add(1, std::memory_order_relaxed);
+
+    QTcpSocket *socket = new QTcpSocket(this);
+    if (!socket->setSocketDescriptor(socketDescriptor)) {
+        delete socket;
+        return;
+    }
+    connect(socket, &QTcpSocket::disconnected, socket, &QObject::deleteLater);
+
+    QByteArray out;
+    appendResponse(out, errorReply(503, "server busy"), false);
+    socket->write(out);
+    socket->disconnectFromHost();
+}
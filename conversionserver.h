@@ -0,0 +1,70 @@
+#ifndef CONVERSIONSERVER_H
+#define CONVERSIONSERVER_H
+
+#include <QTcpServer>
+#include <QThread>
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+class ServerWorker;
+
+// HTTP/1.1 front end for the Units engine.
+//
+//     GET  /convert?from=Miles&to=Feet&value=3
+//     POST /convert          {"from": "Miles", "to": "Feet", "value": 3}
+//     POST /convert/batch    {"from": "Miles", "to": "Feet", "values": [1, 2, 3]}
+//
+// Units are named as for Units::plan: built-in names and their aliases, or
+// any UnitCatalog unit ("yd", "knot", "millimetre").
+//
+// The listening socket only accepts; each connection is handed to one of a
+// fixed set of worker threads, which parses, converts and answers it on its
+// own event loop. Connections are kept alive and pipelined requests are
+// answered in order with one write per read.
+//
+// Backpressure: past maxConnections new clients get an immediate 503 with
+// Retry-After. Within a connection, parsing pauses while more than
+// writeHighWatermark bytes of replies are unsent, and the bounded socket
+// read buffer then pushes back on the client through TCP.
+class ConversionServer : public QTcpServer
+{
+    Q_OBJECT
+
+public:
+    struct Limits {
+        unsigned workers = 0;                   // 0 = one per hardware thread
+        int maxConnections = 4096;
+        int listenBacklog = 1024;
+        qsizetype maxHeaderBytes = 8 * 1024;
+        qsizetype maxBodyBytes = 16 * 1024 * 1024;
+        qsizetype maxBatchValues = 1 << 20;
+        qint64 readBufferBytes = 256 * 1024;
+        qint64 writeHighWatermark = 1024 * 1024;
+        int idleTimeoutMs = 30000;
+    };
+
+    explicit ConversionServer(QObject *parent = nullptr);
+    explicit ConversionServer(const Limits &limits, QObject *parent = nullptr);
+    ~ConversionServer() override;
+
+    unsigned workerCount() const { return static_cast<unsigned>(workers.size()); }
+    int activeConnections() const { return connections.load(std::memory_order_relaxed); }
+    quint64 rejectedConnections() const { return rejected.load(std::memory_order_relaxed); }
+
+protected:
+    void incomingConnection(qintptr socketDescriptor) override;
+
+private:
+    void reject(qintptr socketDescriptor);
+
+    Limits limits;
+    std::vector<QThread *> threads;
+    std::vector<ServerWorker *> workers;
+    std::size_t nextWorker = 0;
+
+    std::atomic<int> connections{0};
+    std::atomic<quint64> rejected{0};
+};
+
+#endif // CONVERSIONSERVER_H
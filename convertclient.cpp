@@ -0,0 +1,168 @@
+#include "convertclient.h"
+
+#include <QDeadlineTimer>
+
+#include <algorithm>
+#include <vector>
+
+using ConvertProtocol::FrameHeader;
+using ConvertProtocol::Op;
+
+ConvertClient::~ConvertClient()
+{
+    disconnectFromDaemon();
+}
+
+bool ConvertClient::connectToDaemon(const QString &serverName, int timeoutMs)
+{
+    disconnectFromDaemon();
+    socket.connectToServer(serverName);
+    return socket.waitForConnected(timeoutMs);
+}
+
+void ConvertClient::disconnectFromDaemon()
+{
+    if (socket.state() != QLocalSocket::UnconnectedState)
+        socket.abort();
+    failPending();
+}
+
+ConvertClient::UnitId ConvertClient::resolve(const QString &name, int timeoutMs, Status *status)
+{
+    const QByteArray utf8 = name.toUtf8();
+    const Ticket ticket = send(Op::Resolve, 0, 0, utf8.constData(), static_cast<std::uint32_t>(utf8.size()), {});
+    const Result result = waitResult(ticket, timeoutMs);
+    if (status) *status = result.status;
+    return result.status == Status::Ok ? result.unit : ConvertProtocol::InvalidUnit;
+}
+
+ConvertClient::Ticket ConvertClient::submit(UnitId from, UnitId to, std::span<const double> in, std::span<double> out)
+{
+    const std::size_t count = std::min(in.size(), out.size());
+    return send(Op::Convert, from, to, reinterpret_cast<const char *>(in.data()),
+                static_cast<std::uint32_t>(count * sizeof(double)), out.first(count));
+}
+
+ConvertClient::Status ConvertClient::wait(Ticket ticket, int timeoutMs)
+{
+    return waitResult(ticket, timeoutMs).status;
+}
+
+ConvertClient::Status ConvertClient::convert(UnitId from, UnitId to, std::span<const double> in,
+                                             std::span<double> out, int timeoutMs)
+{
+    return wait(submit(from, to, in, out), timeoutMs);
+}
+
+/* ===================== FRAMING ===================== */
+
+ConvertClient::Ticket ConvertClient::send(Op op, UnitId from, UnitId to, const char *payload,
+                                          std::uint32_t bytes, std::span<double> out)
+{
+    const Ticket tag = nextTag++;
+    if (!isConnected() || bytes > ConvertProtocol::MaxPayloadBytes) {
+        done[tag] = {Status::Disconnected, ConvertProtocol::InvalidUnit};
+        return tag;
+    }
+
+    FrameHeader header{};
+    header.payloadBytes = bytes;
+    header.tag = tag;
+    header.from = from;
+    header.to = to;
+    header.code = static_cast<std::uint16_t>(op);
+
+    socket.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    if (bytes) socket.write(payload, bytes);
+    socket.flush();     // push what the kernel takes now; the rest goes out while waiting
+
+    pending.push_back({tag, out});
+    return tag;
+}
+
+ConvertClient::Result ConvertClient::waitResult(Ticket ticket, int timeoutMs)
+{
+    const QDeadlineTimer deadline(timeoutMs);
+    for (;;) {
+        const auto it = done.find(ticket);
+        if (it != done.end()) {
+            const Result result = it->second;
+            done.erase(it);
+            return result;
+        }
+        if (pending.empty() || !readReply(static_cast<int>(deadline.remainingTime()))) {
+            // Timed out or lost sync mid-frame: the connection is unusable
+            socket.abort();
+            failPending();
+            const auto failed = done.find(ticket);
+            if (failed == done.end())
+                return {Status::Disconnected, ConvertProtocol::InvalidUnit};
+            const Result result = failed->second;
+            done.erase(failed);
+            return result;
+        }
+    }
+}
+
+// Reads the reply to the oldest pending request, payload straight into its span
+bool ConvertClient::readReply(int timeoutMs)
+{
+    FrameHeader header;
+    if (!readExactly(reinterpret_cast<char *>(&header), sizeof(header), timeoutMs))
+        return false;
+
+    const auto status = static_cast<Status>(header.code);
+    if (status == Status::Busy) {
+        // Refused at accept time, before any request was read
+        for (const Pending &p : pending)
+            done[p.tag] = {Status::Busy, ConvertProtocol::InvalidUnit};
+        pending.clear();
+        socket.abort();
+        return true;
+    }
+
+    const Pending request = pending.front();
+    if (header.tag != request.tag)
+        return false;   // out of sequence; the stream cannot be trusted any more
+    pending.pop_front();
+
+    if (header.payloadBytes > 0) {
+        if (status != Status::Ok || header.payloadBytes != request.out.size_bytes()) {
+            std::vector<char> discard(header.payloadBytes);
+            if (!readExactly(discard.data(), header.payloadBytes, timeoutMs)) return false;
+            done[request.tag] = {Status::BadFrame, ConvertProtocol::InvalidUnit};
+            return true;
+        }
+        if (!readExactly(reinterpret_cast<char *>(request.out.data()), header.payloadBytes, timeoutMs))
+            return false;
+    }
+
+    done[request.tag] = {status, header.from};
+    if (status == Status::BadFrame)
+        socket.abort();     // the daemon closes after this
+    return true;
+}
+
+bool ConvertClient::readExactly(char *data, qint64 size, int timeoutMs)
+{
+    const QDeadlineTimer deadline(timeoutMs);
+    qint64 have = 0;
+    while (have < size) {
+        const qint64 n = socket.read(data + have, size - have);
+        if (n < 0) return false;
+        have += n;
+        if (have == size) break;
+        // Also flushes queued request bytes while it waits
+        if (!socket.waitForReadyRead(static_cast<int>(deadline.remainingTime())))
+            return false;
+    }
+    return true;
+}
+
+// No more replies will come for what is still in flight
+void ConvertClient::failPending()
+{
+    for (const Pending &p : pending)
+        done[p.tag] = {Status::Disconnected, ConvertProtocol::InvalidUnit};
+    pending.clear();
+}
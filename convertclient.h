@@ -0,0 +1,85 @@
+#ifndef CONVERTCLIENT_H
+#define CONVERTCLIENT_H
+
+#include <QLocalSocket>
+#include <QString>
+#include <cstdint>
+#include <deque>
+#include <span>
+#include <unordered_map>
+
+#include "convertprotocol.h"
+
+// Blocking client for convertd with request pipelining.
+//
+//     ConvertClient client;
+//     client.connectToDaemon();
+//     const auto miles = client.resolve("Miles"), km = client.resolve("Kilometers");
+//     auto a = client.submit(miles, km, inA, outA);   // both in flight
+//     auto b = client.submit(miles, km, inB, outB);
+//     client.wait(a); client.wait(b);
+//
+// submit() sends at once and returns a ticket; replies are read straight
+// into the caller's output span, which must stay valid until its ticket
+// has been waited for. Needs no event loop. Not thread-safe: use one
+// client per thread.
+class ConvertClient
+{
+public:
+    using UnitId = ConvertProtocol::UnitId;
+    using Status = ConvertProtocol::Status;
+    using Ticket = std::uint32_t;
+
+    ConvertClient() = default;
+    ~ConvertClient();
+
+    ConvertClient(const ConvertClient&) = delete;
+    ConvertClient& operator=(const ConvertClient&) = delete;
+
+    bool connectToDaemon(const QString &serverName = ConvertProtocol::DefaultServerName, int timeoutMs = 3000);
+    void disconnectFromDaemon();
+    bool isConnected() const { return socket.state() == QLocalSocket::ConnectedState; }
+    QString errorString() const { return socket.errorString(); }
+
+    // Daemon-side ID for a unit name; InvalidUnit if unknown or on error,
+    // with the reason in `status` when given (NotServed for catalogue-only
+    // units). Waits for every earlier request too.
+    UnitId resolve(const QString &name, int timeoutMs = 3000, Status *status = nullptr);
+
+    // Queues the conversion of `in` into `out` (same size). `in` is sent
+    // before submit returns and may be reused or alias `out`.
+    Ticket submit(UnitId from, UnitId to, std::span<const double> in, std::span<double> out);
+
+    // Blocks until `ticket` (and everything submitted before it) is answered
+    Status wait(Ticket ticket, int timeoutMs = 30000);
+
+    Status convert(UnitId from, UnitId to, std::span<const double> in, std::span<double> out,
+                   int timeoutMs = 30000);
+
+    std::size_t inFlight() const { return pending.size(); }
+
+private:
+    struct Pending {
+        Ticket tag;
+        std::span<double> out;
+    };
+
+    struct Result {
+        Status status;
+        UnitId unit;        // Resolve replies only
+    };
+
+    Ticket send(ConvertProtocol::Op op, UnitId from, UnitId to, const char *payload, std::uint32_t bytes,
+                std::span<double> out);
+    Result waitResult(Ticket ticket, int timeoutMs);
+    bool readReply(int timeoutMs);
+    bool readExactly(char *data, qint64 size, int timeoutMs);
+    void failPending();
+
+    QLocalSocket socket;
+    std::deque<Pending> pending;                // sent, not yet answered, in order
+    std::unordered_map<Ticket, Result> done;    // answered, not yet waited for
+    Ticket nextTag = 1;
+};
+
+#endif // CONVERTCLIENT_H
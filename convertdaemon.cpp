@@ -0,0 +1,219 @@
+#include "convertdaemon.h"
+#include "convertprotocol.h"
+#include "requestreader.h"
+#include "unitcatalog.h"
+#include "units.h"
+
+#include <QLocalSocket>
+
+#include <algorithm>
+#include <memory>
+#include <thread>
+#include <unordered_map>
+
+using ConvertProtocol::FrameHeader;
+using ConvertProtocol::Op;
+using ConvertProtocol::RequestReader;
+using ConvertProtocol::Status;
+
+static_assert(ConvertProtocol::InvalidUnit == InvalidUnitId, "protocol and engine unit IDs must agree");
+
+/* ===================== WORKER ===================== */
+
+// Owns the connections handed to one thread; only its event loop touches them
+class DaemonWorker : public QObject
+{
+public:
+    DaemonWorker(const ConvertDaemon::Limits &limits, std::atomic<int> &connections)
+        : limits(limits), connections(connections) {}
+
+    void adopt(quintptr socketDescriptor);
+
+private:
+    struct Connection {
+        QLocalSocket *socket = nullptr;
+        RequestReader reader;
+        bool closing = false;
+    };
+
+    void service(Connection *c);
+    void reply(Connection *c);
+    void fail(Connection *c, Status status);
+    void drop(QLocalSocket *socket);
+
+    const ConvertDaemon::Limits &limits;
+    std::atomic<int> &connections;
+    std::unordered_map<QLocalSocket *, std::unique_ptr<Connection>> open;
+};
+
+void DaemonWorker::adopt(quintptr socketDescriptor)
+{
+    QLocalSocket *socket = new QLocalSocket(this);
+    if (!socket->setSocketDescriptor(socketDescriptor)) {
+        delete socket;
+        connections.fetch_sub(1, std::memory_order_relaxed);
+        return;
+    }
+    socket->setReadBufferSize(limits.readBufferBytes);
+
+    auto c = std::make_unique<Connection>();
+    c->socket = socket;
+    Connection *conn = c.get();
+    open.emplace(socket, std::move(c));
+
+    connect(socket, &QLocalSocket::readyRead, this, [this, conn] { service(conn); });
+    connect(socket, &QLocalSocket::bytesWritten, this, [this, conn] { service(conn); });
+    connect(socket, &QLocalSocket::disconnected, this, [this, socket] { drop(socket); });
+}
+
+// Answers each frame as soon as RequestReader has it complete
+void DaemonWorker::service(Connection *c)
+{
+    QLocalSocket *socket = c->socket;
+    const auto read = [socket](char *to, std::size_t max) -> std::size_t {
+        const qint64 n = socket->read(to, static_cast<qint64>(max));
+        return n > 0 ? static_cast<std::size_t>(n) : 0;
+    };
+
+    while (!c->closing && socket->bytesToWrite() <= limits.writeHighWatermark) {
+        const RequestReader::Step step = c->reader.next(read);
+        if (step == RequestReader::Step::NeedMore) break;
+        if (step == RequestReader::Step::Bad) {
+            fail(c, Status::BadFrame);
+            break;
+        }
+        reply(c);
+    }
+
+    if (c->closing)
+        socket->disconnectFromServer();     // sends what is queued, then closes
+}
+
+void DaemonWorker::reply(Connection *c)
+{
+    const Units &units = Units::getInstance();
+    const FrameHeader &in = c->reader.header();
+    const std::span<char> payload = c->reader.payload();
+    FrameHeader out = in;
+    out.reserved = 0;
+
+    if (in.code == static_cast<std::uint16_t>(Op::Resolve)) {
+        const std::string_view name(payload.data(), payload.size());
+        const UnitId id = units.unitId(name);
+        Status status = Status::Ok;
+        if (id == InvalidUnitId)
+            status = UnitCatalog::builtin().find(name) != InvalidCatalogId ? Status::NotServed : Status::UnknownUnit;
+        out.payloadBytes = 0;
+        out.from = id;
+        out.to = id == InvalidUnitId ? 0 : static_cast<std::uint16_t>(units.unitCategory(id));
+        out.code = static_cast<std::uint16_t>(status);
+        c->socket->write(reinterpret_cast<const char *>(&out), sizeof(out));
+        return;
+    }
+
+    const UnitId from = in.from;
+    const UnitId to = in.to;
+    if (!units.isValid(from) || !units.isValid(to)) {
+        out.payloadBytes = 0;
+        out.code = static_cast<std::uint16_t>(Status::UnknownUnit);
+        c->socket->write(reinterpret_cast<const char *>(&out), sizeof(out));
+        return;
+    }
+
+    const ConversionPlan plan = units.plan(from, to);
+    if (!plan.isValid()) {
+        out.payloadBytes = 0;
+        out.code = static_cast<std::uint16_t>(Status::CannotConvert);
+        c->socket->write(reinterpret_cast<const char *>(&out), sizeof(out));
+        return;
+    }
+
+    // Converted in place and sent back as is, no re-encoding
+    const std::span<double> values(reinterpret_cast<double *>(payload.data()), payload.size() / sizeof(double));
+    plan.apply(values, values);
+
+    out.code = static_cast<std::uint16_t>(Status::Ok);
+    c->socket->write(reinterpret_cast<const char *>(&out), sizeof(out));
+    c->socket->write(payload.data(), static_cast<qint64>(payload.size()));
+}
+
+void DaemonWorker::fail(Connection *c, Status status)
+{
+    FrameHeader out = c->reader.header();
+    out.payloadBytes = 0;
+    out.code = static_cast<std::uint16_t>(status);
+    out.reserved = 0;
+    c->socket->write(reinterpret_cast<const char *>(&out), sizeof(out));
+    c->closing = true;
+}
+
+void DaemonWorker::drop(QLocalSocket *socket)
+{
+    if (open.erase(socket) == 0) return;
+    socket->disconnect(this);
+    socket->deleteLater();
+    connections.fetch_sub(1, std::memory_order_relaxed);
+}
+
+/* ===================== DAEMON ===================== */
+
+ConvertDaemon::ConvertDaemon(QObject *parent)
+    : ConvertDaemon(Limits(), parent)
+{
+}
+
+ConvertDaemon::ConvertDaemon(const Limits &limits, QObject *parent)
+    : QLocalServer(parent), limits(limits)
+{
+    const unsigned count = limits.workers ? limits.workers : std::max(1u, std::thread::hardware_concurrency());
+    for (unsigned i = 0; i < count; ++i) {
+        QThread *thread = new QThread(this);
+        thread->setObjectName(QString("convertd-worker-%1").arg(i));
+        DaemonWorker *worker = new DaemonWorker(this->limits, connections);
+        worker->moveToThread(thread);
+        connect(thread, &QThread::finished, worker, &QObject::deleteLater);
+        thread->start();
+
+        threads.push_back(thread);
+        workers.push_back(worker);
+    }
+}
+
+ConvertDaemon::~ConvertDaemon()
+{
+    close();
+    for (QThread *thread : threads) {
+        thread->quit();
+        thread->wait();
+    }
+}
+
+void ConvertDaemon::incomingConnection(quintptr socketDescriptor)
+{
+    if (connections.load(std::memory_order_relaxed) >= limits.maxConnections) {
+        reject(socketDescriptor);
+        return;
+    }
+    connections.fetch_add(1, std::memory_order_relaxed);
+
+    DaemonWorker *worker = workers[nextWorker];
+    nextWorker = (nextWorker + 1) % workers.size();
+    QMetaObject::invokeMethod(worker, [worker, socketDescriptor] { worker->adopt(socketDescriptor); },
+                              Qt::QueuedConnection);
+}
+
+// Saturated: one Busy frame, then close, so the client can back off
+void ConvertDaemon::reject(quintptr socketDescriptor)
+{
+    QLocalSocket *socket = new QLocalSocket(this);
+    if (!socket->setSocketDescriptor(socketDescriptor)) {
+        delete socket;
+        return;
+    }
+    connect(socket, &QLocalSocket::disconnected, socket, &QObject::deleteLater);
+
+    FrameHeader out{};
+    out.code = static_cast<std::uint16_t>(Status::Busy);
+    socket->write(reinterpret_cast<const char *>(&out), sizeof(out));
+    socket->disconnectFromServer();
+}
@@ -0,0 +1,54 @@
+#ifndef CONVERTDAEMON_H
+#define CONVERTDAEMON_H
+
+#include <QLocalServer>
+#include <QThread>
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+class DaemonWorker;
+
+// Local-socket server for the binary protocol in convertprotocol.h
+// (a Unix domain socket, or a named pipe on Windows).
+//
+// Like ConversionServer, the listener only accepts and hands each
+// connection to one of a fixed set of worker threads. A RequestReader
+// reads payloads straight into a 64-byte aligned per-connection buffer;
+// they are converted in place and written back as is. Requests on a
+// connection may be pipelined and are answered in order. Reading pauses
+// while more than writeHighWatermark reply bytes are unsent.
+class ConvertDaemon : public QLocalServer
+{
+    Q_OBJECT
+
+public:
+    struct Limits {
+        unsigned workers = 0;                   // 0 = one per hardware thread
+        int maxConnections = 1024;
+        qint64 readBufferBytes = 4 * 1024 * 1024;
+        qint64 writeHighWatermark = 16 * 1024 * 1024;
+    };
+
+    explicit ConvertDaemon(QObject *parent = nullptr);
+    explicit ConvertDaemon(const Limits &limits, QObject *parent = nullptr);
+    ~ConvertDaemon() override;
+
+    unsigned workerCount() const { return static_cast<unsigned>(workers.size()); }
+    int activeConnections() const { return connections.load(std::memory_order_relaxed); }
+
+protected:
+    void incomingConnection(quintptr socketDescriptor) override;
+
+private:
+    void reject(quintptr socketDescriptor);
+
+    Limits limits;
+    std::vector<QThread *> threads;
+    std::vector<DaemonWorker *> workers;
+    std::size_t nextWorker = 0;
+
+    std::atomic<int> connections{0};
+};
+
+#endif // CONVERTDAEMON_H
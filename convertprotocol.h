@@ -0,0 +1,54 @@
+#ifndef CONVERTPROTOCOL_H
+#define CONVERTPROTOCOL_H
+
+#include <cstdint>
+
+// Binary framing shared by convertd and ConvertClient.
+//
+// Every frame, in both directions, is a 16-byte FrameHeader followed by
+// payloadBytes of payload. Both ends share a host, so fields are in native
+// byte order and doubles are sent as their raw bytes.
+//
+//     Convert  request: from, to; payload = N doubles
+//              reply:   Status; payload = N converted doubles (Ok only)
+//     Resolve  request: payload = UTF-8 unit name
+//              reply:   Status; `from` = the unit's ID, `to` = its category
+//
+// Only units in the Units table (the built-in units and any added with
+// Units::addUnit) have IDs and are served. Names that only the wider
+// UnitCatalog knows resolve to NotServed rather than UnknownUnit.
+//
+// Replies come back in request order and echo the request's tag.
+namespace ConvertProtocol {
+
+using UnitId = std::uint16_t;                   // same handle as Units::unitId()
+inline constexpr UnitId InvalidUnit = 0xFFFF;
+
+inline constexpr char DefaultServerName[] = "convertd";
+inline constexpr std::uint32_t MaxPayloadBytes = 64u << 20;
+
+enum class Op : std::uint16_t { Convert = 1, Resolve = 2 };
+
+enum class Status : std::uint16_t {
+    Ok = 0,
+    UnknownUnit = 1,
+    CannotConvert = 2,      // mismatched categories or missing currency rate
+    BadFrame = 3,           // daemon closes the connection after this
+    Busy = 4,               // too many connections; sent before closing
+    Disconnected = 5,       // client side only: no reply will come
+    NotServed = 6,          // Resolve: a catalogue unit, which has no ID here
+};
+
+struct FrameHeader {
+    std::uint32_t payloadBytes;
+    std::uint32_t tag;          // chosen by the client, echoed in the reply
+    std::uint16_t from;
+    std::uint16_t to;
+    std::uint16_t code;         // Op in requests, Status in replies
+    std::uint16_t reserved;
+};
+static_assert(sizeof(FrameHeader) == 16, "FrameHeader must stay 16 bytes");
+
+} // namespace ConvertProtocol
+
+#endif // CONVERTPROTOCOL_H
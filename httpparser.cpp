@@ -0,0 +1,125 @@
+#include "httpparser.h"
+
+#include <charconv>
+
+namespace HttpParser {
+
+namespace {
+
+bool equalsIgnoreCase(std::string_view a, std::string_view b)
+{
+    if (a.size() != b.size()) return false;
+    for (std::size_t i = 0; i < a.size(); ++i) {
+        char x = a[i], y = b[i];
+        if (x >= 'A' && x <= 'Z') x = static_cast<char>(x - 'A' + 'a');
+        if (y >= 'A' && y <= 'Z') y = static_cast<char>(y - 'A' + 'a');
+        if (x != y) return false;
+    }
+    return true;
+}
+
+bool containsToken(std::string_view list, std::string_view token)
+{
+    while (!list.empty()) {
+        std::size_t comma = list.find(',');
+        std::string_view item = list.substr(0, comma);
+        while (!item.empty() && (item.front() == ' ' || item.front() == '\t')) item.remove_prefix(1);
+        while (!item.empty() && (item.back() == ' ' || item.back() == '\t')) item.remove_suffix(1);
+        if (equalsIgnoreCase(item, token)) return true;
+        if (comma == std::string_view::npos) break;
+        list.remove_prefix(comma + 1);
+    }
+    return false;
+}
+
+} // namespace
+
+ParseResult parseRequest(std::string_view buffer, const Limits &limits,
+                         Request &req, std::size_t &consumed, int &status, bool &expectContinue)
+{
+    // Tolerate stray CRLFs between pipelined requests
+    std::size_t start = 0;
+    while (buffer.substr(start, 2) == "\r\n") start += 2;
+
+    const std::size_t headerEnd = buffer.find("\r\n\r\n", start);
+    if (headerEnd == std::string_view::npos) {
+        if (buffer.size() - start > limits.maxHeaderBytes) {
+            status = 431;
+            return ParseResult::Error;
+        }
+        return ParseResult::Incomplete;
+    }
+    if (headerEnd - start > limits.maxHeaderBytes) {
+        status = 431;
+        return ParseResult::Error;
+    }
+
+    // Request line: METHOD SP TARGET SP HTTP/1.x
+    std::string_view head = buffer.substr(start, headerEnd - start);
+    std::size_t lineEnd = head.find("\r\n");
+    std::string_view line = head.substr(0, lineEnd);
+    const std::size_t sp1 = line.find(' ');
+    const std::size_t sp2 = line.rfind(' ');
+    if (sp1 == std::string_view::npos || sp2 == sp1) {
+        status = 400;
+        return ParseResult::Error;
+    }
+    req.method = line.substr(0, sp1);
+    req.target = line.substr(sp1 + 1, sp2 - sp1 - 1);
+    const std::string_view version = line.substr(sp2 + 1);
+    if (version.substr(0, 7) != "HTTP/1.") {
+        status = version.substr(0, 5) == "HTTP/" ? 505 : 400;
+        return ParseResult::Error;
+    }
+    req.keepAlive = version == "HTTP/1.1";
+
+    // Headers
+    std::size_t contentLength = 0;
+    expectContinue = false;
+    while (lineEnd != std::string_view::npos) {
+        head.remove_prefix(lineEnd + 2);
+        lineEnd = head.find("\r\n");
+        line = head.substr(0, lineEnd);
+
+        const std::size_t colon = line.find(':');
+        if (colon == std::string_view::npos) {
+            status = 400;
+            return ParseResult::Error;
+        }
+        const std::string_view name = line.substr(0, colon);
+        std::string_view value = line.substr(colon + 1);
+        while (!value.empty() && (value.front() == ' ' || value.front() == '\t')) value.remove_prefix(1);
+        while (!value.empty() && (value.back() == ' ' || value.back() == '\t')) value.remove_suffix(1);
+
+        if (equalsIgnoreCase(name, "content-length")) {
+            const auto r = std::from_chars(value.data(), value.data() + value.size(), contentLength);
+            if (r.ec != std::errc() || r.ptr != value.data() + value.size()) {
+                status = 400;
+                return ParseResult::Error;
+            }
+        } else if (equalsIgnoreCase(name, "transfer-encoding")) {
+            status = 501;   // chunked bodies are not supported
+            return ParseResult::Error;
+        } else if (equalsIgnoreCase(name, "connection")) {
+            if (containsToken(value, "close")) req.keepAlive = false;
+            else if (containsToken(value, "keep-alive")) req.keepAlive = true;
+        } else if (equalsIgnoreCase(name, "expect")) {
+            expectContinue = equalsIgnoreCase(value, "100-continue");
+        }
+    }
+
+    if (contentLength > limits.maxBodyBytes) {
+        status = 413;
+        return ParseResult::Error;
+    }
+
+    const std::size_t bodyStart = headerEnd + 4;
+    if (buffer.size() - bodyStart < contentLength)
+        return ParseResult::Incomplete;
+
+    req.body = buffer.substr(bodyStart, contentLength);
+    consumed = bodyStart + contentLength;
+    return ParseResult::Complete;
+}
+
+} // namespace HttpParser
@@ -0,0 +1,38 @@
+#ifndef HTTPPARSER_H
+#define HTTPPARSER_H
+
+#include <cstddef>
+#include <string_view>
+
+// The subset of HTTP/1.1 request parsing ConversionServer needs, kept free
+// of Qt so it can be exercised on plain byte strings.
+//
+// Requests are parsed in place from the front of a buffer that may hold
+// part of a request or several pipelined ones; the views in Request point
+// into that buffer. Bodies need Content-Length: Transfer-Encoding is
+// refused with 501, as chunked bodies are not supported.
+namespace HttpParser {
+
+struct Request {
+    std::string_view method;
+    std::string_view target;    // path and query
+    std::string_view body;
+    bool keepAlive = true;
+};
+
+struct Limits {
+    std::size_t maxHeaderBytes;
+    std::size_t maxBodyBytes;
+};
+
+enum class ParseResult { Complete, Incomplete, Error };
+
+// Parses one request from the front of `buffer`. On Complete, `consumed`
+// is its full length; on Error, `status` is the code to answer with before
+// closing. `expectContinue` is set when the client waits for 100 Continue.
+ParseResult parseRequest(std::string_view buffer, const Limits &limits,
+                         Request &req, std::size_t &consumed, int &status, bool &expectContinue);
+
+} // namespace HttpParser
+
+#endif // HTTPPARSER_H
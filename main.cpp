@@ -1,10 +1,25 @@
 #include "mainwindow.h"
+#include "trace.h"
 #include <QApplication>
+#include <QElapsedTimer>
+#include <cstring>
 
 int main(int argc, char *argv[])
 {
+    QElapsedTimer launch;
+    launch.start();
+
+    // --trace FILE: same as CONVERTER_TRACE=FILE
+    for (int i = 1; i + 1 < argc; ++i) {
+        if (!std::strcmp(argv[i], "--trace")) Trace::start(argv[i + 1]);
+    }
+
+    const std::uint64_t appBegin = Trace::now();
     QApplication a(argc, argv);
+    Trace::complete("QApplication", appBegin, Trace::now());
+
     MainWindow w;
+    w.setLaunchTimer(launch);
     w.show();
     return a.exec();
 }
@@ -1,4 +1,7 @@
 #include "mainwindow.h"
+#include "ratescache.h"
+#include "trace.h"
+#include "unitcombo.h"
 
 #include <QVBoxLayout>
 #include <QGridLayout>
@@ -7,7 +10,6 @@
 #include <QJsonObject>
 #include <QJsonValue>
 #include <QJsonArray>
-#include <QUrlQuery>
 #include <QFont>
 #include <QFrame>
 #include <QSpacerItem>
@@ -16,10 +18,13 @@
 #include <QApplication>
 #include <QStatusBar>
 
+// Cached rates older than this are flagged in the Currency tab
+static constexpr qint64 StaleRatesSeconds = 24 * 3600;
 
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent)
 {
+    TRACE_SCOPE("MainWindow");
     setWindowTitle("Multi-Unit Converter");
     resize(820, 620);
 
@@ -29,7 +34,6 @@ MainWindow::MainWindow(QWidget *parent)
     mainToolBar = new QToolBar("Main", this);
     mainToolBar->setMovable(false);
     addToolBar(Qt::TopToolBarArea, mainToolBar);
-    mainToolBar->setStyleSheet("QToolBar { spacing: 10px; padding: 6px; }");
 
     QAction *aboutAction = new QAction("About", this);
     mainToolBar->addAction(aboutAction);
@@ -40,33 +44,33 @@ MainWindow::MainWindow(QWidget *parent)
 
     // Main header
     QLabel *appTitle = new QLabel("Multi-Unit Converter", this);
-    appTitle->setStyleSheet("font-size: 28px; font-weight: 700; color: #0B5FFF;");
+    appTitle->setObjectName("appTitle");
     appTitle->setAlignment(Qt::AlignCenter);
 
     // Tabs container card
     QFrame *card = new QFrame(this);
     card->setFrameShape(QFrame::Box);
-    card->setStyleSheet(
-        "QFrame { background: #ffffff; border-radius: 10px; padding: 18px; }"
-        );
+    card->setObjectName("card");
 
     QVBoxLayout *cardLayout = new QVBoxLayout(card);
 
     tabWidget = new QTabWidget(this);
     tabWidget->setTabPosition(QTabWidget::North);
 
-    // Create tabs
+    // Create tabs; only the visible one is built now, the rest on first use
     setupTab(UnitCategory::Length, "Length");
     setupTab(UnitCategory::Weight, "Weight");
     setupTab(UnitCategory::Temperature, "Temperature");
     setupTab(UnitCategory::Volume, "Volume");
     setupTab(UnitCategory::Speed, "Speed");
     setupTab(UnitCategory::Currency, "Currency");
+    buildTab(static_cast<UnitCategory>(tabWidget->currentIndex()));
 
-    tabWidget->setStyleSheet(
-        "QTabBar::tab { min-width: 90px; padding: 8px 12px; }"
-        "QTabWidget::pane { border: none; }"
-        );
+    connect(tabWidget, &QTabWidget::currentChanged, this, [this](int index) {
+        const UnitCategory category = static_cast<UnitCategory>(index);
+        buildTab(category);
+        if (category == UnitCategory::Currency) startRates();
+    });
 
     cardLayout->addWidget(tabWidget);
 
@@ -84,40 +88,68 @@ MainWindow::MainWindow(QWidget *parent)
     statusBar()->addPermanentWidget(mainStatusLabel);
 
     // ---------- Network setup ----------
-    networkManager = new QNetworkAccessManager(this);
-    requestInProgress = false;
-
-    refreshTimer = new QTimer(this);
-    requestTimeoutTimer = new QTimer(this);
-
-    ratesApiEndpoint = "https://api.exchangerate.host/latest";
-    refreshIntervalSeconds = 3600;
-    requestTimeoutMs = 8000;
-
-    connect(networkManager, &QNetworkAccessManager::finished,
-            this, &MainWindow::onRatesReplyFinished);
+    // The fetcher lives on its own thread; only its queued signals reach
+    // this one, so a large payload never stalls the event loop. The thread
+    // (cache load, network and TLS setup) starts after the first frame.
+    ratesThread = new QThread(this);
+    ratesThread->setObjectName("rates");
+    RatesFetcher::Settings ratesSettings;
+    ratesSettings.cachePath = RatesCache::defaultPath();
+    if (qEnvironmentVariableIsSet("RATES_ENDPOINTS"))   // e.g. local mockrates instances
+        ratesSettings.providers = RatesFetcher::providersFromString(qEnvironmentVariable("RATES_ENDPOINTS"));
+    ratesFetcher = new RatesFetcher(ratesSettings);
+    ratesFetcher->moveToThread(ratesThread);
+
+    connect(ratesThread, &QThread::started, ratesFetcher, &RatesFetcher::start);
+    connect(ratesThread, &QThread::finished, ratesFetcher, &QObject::deleteLater);
+    connect(ratesFetcher, &RatesFetcher::cachedRatesLoaded, this, &MainWindow::onCachedRatesLoaded);
+    connect(ratesFetcher, &RatesFetcher::fetchStarted, this, &MainWindow::onRatesFetchStarted);
+    connect(ratesFetcher, &RatesFetcher::ratesPublished, this, &MainWindow::onRatesPublished);
+    connect(ratesFetcher, &RatesFetcher::ratesUnchanged, this, &MainWindow::onRatesUnchanged);
+    connect(ratesFetcher, &RatesFetcher::fetchFailed, this, &MainWindow::onRatesFetchFailed);
+}
 
-    connect(refreshTimer, &QTimer::timeout, this, [this]() {
-        fetchRates("USD");
-    });
+void MainWindow::setLaunchTimer(const QElapsedTimer &timer)
+{
+    launchTimer = timer;
+}
 
-    connect(requestTimeoutTimer, &QTimer::timeout,
-            this, &MainWindow::onRatesFetchTimeout);
+// The first paint of the window marks the first frame; everything not
+// needed for it is started from here
+void MainWindow::paintEvent(QPaintEvent *event)
+{
+    QMainWindow::paintEvent(event);
+    if (firstFramePainted) return;
+
+    firstFramePainted = true;
+    Trace::instant("firstFrame");
+    if (launchTimer.isValid() && qEnvironmentVariableIsSet("CONVERTER_STARTUP_TIMING"))
+        qInfo("first frame %lld ms after launch", launchTimer.elapsed());
+    QTimer::singleShot(0, this, &MainWindow::startRates);
+}
 
-    // Start refreshing and fetch initially
-    refreshTimer->start(refreshIntervalSeconds * 1000);
-    fetchRates("USD");
+// Load cached rates, start refreshing and fetch initially
+void MainWindow::startRates()
+{
+    TRACE_SCOPE("startRates");
+    if (!ratesThread->isRunning() && !ratesThread->isFinished())
+        ratesThread->start();
 }
 
 MainWindow::~MainWindow()
 {
+    ratesThread->quit();
+    ratesThread->wait();
     delete ui;
 }
 
 /* ----------------------- Styling ------------------------ */
 void MainWindow::applyGlobalStyle()
 {
-    // Basic modern look
+    TRACE_SCOPE("applyGlobalStyle");
+    // Basic modern look. Everything is in this one sheet, applied before
+    // any child widget exists: per-widget sheets would each be parsed and
+    // cascaded separately, and a later app-wide sheet repolishes every widget.
     QString style = R"(
         QWidget { background: #f3f6fb; font-family: "Segoe UI", Roboto, Arial; }
         QLabel { color: #333333; }
@@ -126,24 +158,45 @@ void MainWindow::applyGlobalStyle()
         QLineEdit { padding: 8px; border: 1px solid #cfd8ef; border-radius: 6px; background: white; }
         QComboBox { padding: 6px 8px; border: 1px solid #cfd8ef; border-radius: 6px; background: white; }
         QLabel#bigResult { font-size: 20px; font-weight: 700; color: #0B5FFF; }
+        QToolBar { spacing: 10px; padding: 6px; }
+        QLabel#appTitle { font-size: 28px; font-weight: 700; color: #0B5FFF; }
+        #card, #card QFrame { background: #ffffff; border-radius: 10px; padding: 18px; }
+        QTabBar::tab { min-width: 90px; padding: 8px 12px; }
+        QTabWidget::pane { border: none; }
+        QLabel#tabHeader { font-size: 20px; font-weight: 600; color: #222; }
+        QLabel#etaHeader { color:#666; font-size:13px; }
+        QLabel#eta { color:#D35400; font-weight:600; }
+        QLabel#ratesStatus { color:#555; font-size:12px; }
     )";
     qApp->setStyleSheet(style);
 }
 
 /* ------------------------ Tabs -------------------------- */
+// Adds an empty page; tab index == category, so pages go in category order
 void MainWindow::setupTab(UnitCategory category, const QString &title)
 {
+    Q_ASSERT(tabWidget->count() == static_cast<int>(category));
+    tabWidget->addTab(new QWidget, title);
+}
+
+// Fills in a tab's page the first time it is shown
+void MainWindow::buildTab(UnitCategory category)
+{
+    if (tabs.count(category)) return;
+    TRACE_SCOPE_ARG("buildTab", category);
+
     TabWidgets tw;
-    tw.tab = new QWidget;
+    tw.tab = tabWidget->widget(static_cast<int>(category));
+    const QString title = tabWidget->tabText(static_cast<int>(category));
 
     // Title inside tab
     QLabel *tabHeader = new QLabel(title + " Conversion", tw.tab);
-    tabHeader->setStyleSheet("font-size: 20px; font-weight: 600; color: #222;");
+    tabHeader->setObjectName("tabHeader");
     tabHeader->setAlignment(Qt::AlignCenter);
 
     // From/To grid
-    tw.cmbUnitFrom = new QComboBox;
-    tw.cmbUnitTo = new QComboBox;
+    tw.cmbUnitFrom = new UnitPicker;
+    tw.cmbUnitTo = new UnitPicker;
 
     tw.lnEdtInput = new QLineEdit;
     tw.lnEdtInput->setPlaceholderText("Enter value to convert");
@@ -156,9 +209,9 @@ void MainWindow::setupTab(UnitCategory category, const QString &title)
     tw.btnReverse = new QPushButton("Reverse");
     tw.btnReverse->setObjectName("secondary");
 
-    // Populate units (Units singleton)
-    Units::getInstance().populateUnits(tw.cmbUnitFrom, category);
-    Units::getInstance().populateUnits(tw.cmbUnitTo, category);
+    // Units from the category's shared model (searchable as you type)
+    tw.cmbUnitFrom->setCategory(category);
+    tw.cmbUnitTo->setCategory(category);
 
     // Layout
     QVBoxLayout *layout = new QVBoxLayout;
@@ -191,7 +244,7 @@ void MainWindow::setupTab(UnitCategory category, const QString &title)
     if (category == UnitCategory::Speed) {
         QLabel *etaHeader = new QLabel("ETA Calculator (distance in meters)", tw.tab);
         etaHeader->setAlignment(Qt::AlignCenter);
-        etaHeader->setStyleSheet("color:#666; font-size:13px;");
+        etaHeader->setObjectName("etaHeader");
         layout->addWidget(etaHeader);
 
         tw.lnEdtDistance = new QLineEdit;
@@ -199,7 +252,7 @@ void MainWindow::setupTab(UnitCategory category, const QString &title)
 
         tw.lblEta = new QLabel("ETA: -");
         tw.lblEta->setAlignment(Qt::AlignCenter);
-        tw.lblEta->setStyleSheet("color:#D35400; font-weight:600;");
+        tw.lblEta->setObjectName("eta");
 
         QHBoxLayout *etaRow = new QHBoxLayout;
         etaRow->addStretch();
@@ -215,12 +268,11 @@ void MainWindow::setupTab(UnitCategory category, const QString &title)
         ratesRow->setContentsMargins(0, 10, 0, 0);
 
         tw.lblRatesStatus = new QLabel("Rates: updating...", tw.tab);
-        tw.lblRatesStatus->setStyleSheet("color:#555; font-size:12px;");
+        tw.lblRatesStatus->setObjectName("ratesStatus");
 
         tw.ratesProgress = new QProgressBar(tw.tab);
         tw.ratesProgress->setFixedSize(140, 14);
         tw.ratesProgress->setTextVisible(false);
-        tw.ratesProgress->setRange(0, 0); // busy indicator
 
         ratesRow->addStretch();
         ratesRow->addWidget(tw.lblRatesStatus);
@@ -229,9 +281,6 @@ void MainWindow::setupTab(UnitCategory category, const QString &title)
         ratesRow->addStretch();
 
         layout->addLayout(ratesRow);
-
-        // Initially disable currency convert until rates load
-        tw.btnSubmit->setEnabled(false);
     }
 
     // Buttons and result
@@ -247,17 +296,23 @@ void MainWindow::setupTab(UnitCategory category, const QString &title)
     layout->addWidget(tw.lblOutputResult);
 
     tw.tab->setLayout(layout);
-    tabWidget->addTab(tw.tab, title);
     tabs[category] = tw;
 
     // Connect signals
     connect(tw.btnSubmit, &QPushButton::clicked, this, &MainWindow::convertUnits);
     connect(tw.btnReverse, &QPushButton::clicked, this, &MainWindow::reverseConversion);
+
+    // Rates status reported while the tab did not exist yet
+    if (category == UnitCategory::Currency) {
+        updateCurrencyStatus(currencyStatusText, currencyBusy);
+        setCurrencyControlsEnabled(currencyControlsEnabled);
+    }
 }
 
 /* --------------------- Conversion ----------------------- */
 void MainWindow::convertUnits()
 {
+    TRACE_SCOPE("convertUnits");
     UnitCategory currentCategory = static_cast<UnitCategory>(tabWidget->currentIndex());
     auto &tw = tabs[currentCategory];
 
@@ -271,26 +326,26 @@ void MainWindow::convertUnits()
     // Currency special-case
     if (currentCategory == UnitCategory::Currency) {
         double directRate = 0.0;
-        if (Units::getInstance().getCurrencyRate(tw.cmbUnitFrom->currentText(),
-                                                 tw.cmbUnitTo->currentText(), directRate)) {
+        if (Units::getInstance().getCurrencyRate(tw.cmbUnitFrom->currentUnit(),
+                                                 tw.cmbUnitTo->currentUnit(), directRate)) {
             double result = value * directRate;
             tw.lblOutputResult->setText("Result: " + QString::number(result, 'f', 4));
             // update status
             mainStatusLabel->setText(QString("Converted %1 %2 → %3")
-                                         .arg(value).arg(tw.cmbUnitFrom->currentText()).arg(tw.cmbUnitTo->currentText()));
+                                         .arg(value).arg(tw.cmbUnitFrom->currentUnit()).arg(tw.cmbUnitTo->currentUnit()));
             return;
         }
 
         // If no rate available yet, start fetch and notify user
-        if (!requestInProgress) fetchRates("USD");
+        fetchRates();
         QMessageBox::information(this, "Please wait", "Currency rates are updating. Try again in a moment.");
         return;
     }
 
     // Normal conversions
     double result = Units::getInstance().convert(
-        tw.cmbUnitFrom->currentText(),
-        tw.cmbUnitTo->currentText(),
+        tw.cmbUnitFrom->currentUnit(),
+        tw.cmbUnitTo->currentUnit(),
         value
         );
 
@@ -305,20 +360,13 @@ void MainWindow::reverseConversion()
     UnitCategory currentCategory = static_cast<UnitCategory>(tabWidget->currentIndex());
     auto &tw = tabs[currentCategory];
 
-    QString temp = tw.cmbUnitFrom->currentText();
-    tw.cmbUnitFrom->setCurrentText(tw.cmbUnitTo->currentText());
-    tw.cmbUnitTo->setCurrentText(temp);
+    QString temp = tw.cmbUnitFrom->currentUnit();
+    tw.cmbUnitFrom->setCurrentUnit(tw.cmbUnitTo->currentUnit());
+    tw.cmbUnitTo->setCurrentUnit(temp);
 
     convertUnits();
 }
 
-/* ------------------- Update Units ----------------------- */
-void MainWindow::updateUnits()
-{
-    UnitCategory currentCategory = static_cast<UnitCategory>(tabWidget->currentIndex());
-    Units::getInstance().populateUnits(tabs[currentCategory].cmbUnitTo, currentCategory);
-}
-
 /* ---------------------- ETA ----------------------------- */
 void MainWindow::calculateETA(TabWidgets &tw)
 {
@@ -350,90 +398,72 @@ void MainWindow::calculateETA(TabWidgets &tw)
 }
 
 /* --------------------- Networking ----------------------- */
-void MainWindow::fetchRates(const QString &baseCurrency)
+void MainWindow::fetchRates()
 {
     if (requestInProgress) return;
+    if (!ratesThread->isRunning()) {
+        startRates();   // the fetcher fetches once it starts
+        return;
+    }
+    QMetaObject::invokeMethod(ratesFetcher, &RatesFetcher::fetchRates, Qt::QueuedConnection);
+}
 
+void MainWindow::onCachedRatesLoaded(quint64, int, const QDateTime &fetchedAt)
+{
+    lastRatesUpdate = fetchedAt;
+    updateCurrencyStatus("Cached rates" + ratesAgeText(), requestInProgress);
+    setCurrencyControlsEnabled(true);
+}
+
+void MainWindow::onRatesFetchStarted()
+{
     requestInProgress = true;
+    if (lastRatesUpdate.isValid()) {
+        // Keep converting with the rates we have while fetching
+        updateCurrencyStatus("Fetching rates..." + ratesAgeText(), true);
+        return;
+    }
     updateCurrencyStatus("Fetching rates...", true);
     setCurrencyControlsEnabled(false);
-
-    QUrl url(ratesApiEndpoint);
-    QUrlQuery q;
-    q.addQueryItem("base", baseCurrency);
-    url.setQuery(q);
-
-    QNetworkRequest request(url);
-    networkManager->get(request);
-    requestTimeoutTimer->start(requestTimeoutMs);
 }
 
-void MainWindow::onRatesReplyFinished(QNetworkReply *reply)
+void MainWindow::onRatesPublished(quint64, int, int, const QString &provider)
 {
-    requestTimeoutTimer->stop();
+    TRACE_SCOPE("onRatesPublished");
     requestInProgress = false;
-
-    if (reply->error() != QNetworkReply::NoError) {
-        reply->deleteLater();
-        updateCurrencyStatus("Failed to update rates", false);
-        setCurrencyControlsEnabled(true); // still enable to allow user try cached conversions
-        return;
-    }
-
-    QByteArray data = reply->readAll();
-    reply->deleteLater();
-
-    QJsonDocument doc = QJsonDocument::fromJson(data);
-    if (!doc.isObject()) {
-        updateCurrencyStatus("Invalid rates data", false);
-        setCurrencyControlsEnabled(true);
-        return;
-    }
-
-    QJsonObject obj = doc.object();
-    QString base = obj.contains("base") ? obj["base"].toString() : "USD";
-    QJsonObject ratesObj = obj["rates"].toObject();
-    if (ratesObj.isEmpty()) {
-        updateCurrencyStatus("Rates empty", false);
-        setCurrencyControlsEnabled(true);
-        return;
-    }
-
-    // Build rates map
-    QMap<QString, double> ratesMap;
-    ratesMap[base] = 1.0;
-    for (auto it = ratesObj.begin(); it != ratesObj.end(); ++it) {
-        ratesMap[it.key()] = it.value().toDouble();
-    }
-
-    // Populate Units with pairwise rates
-    QList<QString> keys = ratesMap.keys();
-    for (const QString &a : keys) {
-        for (const QString &b : keys) {
-            double ra = ratesMap.value(a, 0.0);
-            double rb = ratesMap.value(b, 0.0);
-            if (ra > 0.0 && rb > 0.0) {
-                Units::getInstance().setCurrencyRate(a, b, rb / ra);
-            }
-        }
-    }
-
     lastRatesUpdate = QDateTime::currentDateTimeUtc();
     updateCurrencyStatus("Rates updated • " + lastRatesUpdate.toLocalTime().toString("hh:mm:ss"), false);
     setCurrencyControlsEnabled(true);
-    mainStatusLabel->setText("Rates updated");
+    mainStatusLabel->setText("Rates updated from " + provider);
 }
 
-void MainWindow::onRatesFetchTimeout()
+void MainWindow::onRatesUnchanged(const QString &)
 {
     requestInProgress = false;
-    updateCurrencyStatus("Fetch timed out", false);
+    lastRatesUpdate = QDateTime::currentDateTimeUtc();
+    updateCurrencyStatus("Rates up to date • " + lastRatesUpdate.toLocalTime().toString("hh:mm:ss"), false);
     setCurrencyControlsEnabled(true);
 }
 
+void MainWindow::onRatesFetchFailed(RatesFetcher::Failure reason)
+{
+    requestInProgress = false;
+    QString text;
+    switch (reason) {
+    case RatesFetcher::Failure::Network: text = "Failed to update rates"; break;
+    case RatesFetcher::Failure::Timeout: text = "Fetch timed out"; break;
+    case RatesFetcher::Failure::Invalid: text = "Invalid rates data"; break;
+    case RatesFetcher::Failure::Empty:   text = "Rates empty"; break;
+    }
+    updateCurrencyStatus(text + ratesAgeText(), false);
+    setCurrencyControlsEnabled(true); // still enable to allow user try cached conversions
+}
+
 /* -------------------- UI helpers ------------------------ */
 void MainWindow::updateCurrencyStatus(const QString &text, bool busy)
 {
+    currencyStatusText = text;
+    currencyBusy = busy;
     auto it = tabs.find(UnitCategory::Currency);
     if (it == tabs.end()) return;
     TabWidgets &ctw = it->second;
@@ -444,8 +474,22 @@ void MainWindow::updateCurrencyStatus(const QString &text, bool busy)
     }
 }
 
+// " • rates from <time>", flagged when stale; empty before any rates
+QString MainWindow::ratesAgeText() const
+{
+    if (!lastRatesUpdate.isValid()) return QString();
+
+    const QDateTime local = lastRatesUpdate.toLocalTime();
+    const bool today = local.date() == QDate::currentDate();
+    QString text = " • rates from " + local.toString(today ? "hh:mm" : "d MMM hh:mm");
+    if (lastRatesUpdate.secsTo(QDateTime::currentDateTimeUtc()) > StaleRatesSeconds)
+        text += " (stale)";
+    return text;
+}
+
 void MainWindow::setCurrencyControlsEnabled(bool enabled)
 {
+    currencyControlsEnabled = enabled;
     auto it = tabs.find(UnitCategory::Currency);
     if (it == tabs.end()) return;
     TabWidgets &ctw = it->second;
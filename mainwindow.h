@@ -8,19 +8,21 @@
 #include <QPushButton>
 #include <QTabWidget>
 #include <unordered_map>
-#include <QNetworkAccessManager>
-#include <QNetworkReply>
-#include <QTimer>
+#include <QThread>
 #include <QProgressBar>
 #include <QToolBar>
 #include <QDateTime>
+#include <QElapsedTimer>
 
 #include "units.h"
+#include "ratesfetcher.h"
 
 QT_BEGIN_NAMESPACE
 namespace Ui { class MainWindow; }
 QT_END_NAMESPACE
 
+class UnitPicker;
+
 class MainWindow : public QMainWindow
 {
     Q_OBJECT
@@ -29,14 +31,22 @@ public:
     explicit MainWindow(QWidget *parent = nullptr);
     ~MainWindow() override;
 
+    // Started at process launch; time to first frame is measured from it
+    void setLaunchTimer(const QElapsedTimer &timer);
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+
 private slots:
     void convertUnits();
     void reverseConversion();
-    void updateUnits();
 
-    // Network
-    void onRatesReplyFinished(QNetworkReply *reply);
-    void onRatesFetchTimeout();
+    // Rates (queued from the fetcher thread)
+    void onCachedRatesLoaded(quint64 version, int currencies, const QDateTime &fetchedAt);
+    void onRatesFetchStarted();
+    void onRatesPublished(quint64 version, int currencies, int changed, const QString &provider);
+    void onRatesUnchanged(const QString &provider);
+    void onRatesFetchFailed(RatesFetcher::Failure reason);
 
 private:
     Ui::MainWindow *ui;
@@ -45,8 +55,8 @@ private:
 
     struct TabWidgets {
         QWidget *tab = nullptr;
-        QComboBox *cmbUnitFrom = nullptr;
-        QComboBox *cmbUnitTo = nullptr;
+        UnitPicker *cmbUnitFrom = nullptr;
+        UnitPicker *cmbUnitTo = nullptr;
         QLineEdit *lnEdtInput = nullptr;
         QLabel *lblOutputResult = nullptr;
         QPushButton *btnSubmit = nullptr;
@@ -64,27 +74,33 @@ private:
     std::unordered_map<UnitCategory, TabWidgets> tabs;
 
     void setupTab(UnitCategory category, const QString &title);
+    void buildTab(UnitCategory category);
     void calculateETA(TabWidgets &tw);
 
-    // Currency API
-    QNetworkAccessManager *networkManager = nullptr;
-    QTimer *refreshTimer = nullptr;
-    QTimer *requestTimeoutTimer = nullptr;
+    // Currency API: download, parsing and publishing run on ratesThread
+    QThread *ratesThread = nullptr;
+    RatesFetcher *ratesFetcher = nullptr;
+    bool requestInProgress = false;
+
+    void startRates();
+    void fetchRates();
 
-    QString ratesApiEndpoint;
-    int refreshIntervalSeconds;
-    int requestTimeoutMs;
-    bool requestInProgress;
+    // Currency tab state, kept while the tab is not built yet
+    QString currencyStatusText = "Rates: updating...";
+    bool currencyBusy = true;
+    bool currencyControlsEnabled = false;
 
-    void fetchRates(const QString &baseCurrency = "USD");
+    QElapsedTimer launchTimer;
+    bool firstFramePainted = false;
 
     // UI helpers
     void applyGlobalStyle();
     void updateCurrencyStatus(const QString &text, bool busy = false);
+    QString ratesAgeText() const;
     void setCurrencyControlsEnabled(bool enabled);
     QToolBar *mainToolBar = nullptr;
     QLabel *mainStatusLabel = nullptr;
-    QDateTime lastRatesUpdate;
+    QDateTime lastRatesUpdate;      // when the rates in use were fetched
 };
 
 #endif // MAINWINDOW_H
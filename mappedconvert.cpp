@@ -0,0 +1,124 @@
+#include "mappedconvert.h"
+#include "threadpool.h"
+
+#include <QFile>
+#include <QFileInfo>
+#include <QtGlobal>
+
+#if defined(Q_OS_UNIX)
+#include <sys/mman.h>
+#endif
+
+namespace MappedConvert {
+
+namespace {
+
+bool fail(QString *errorString, const QString &message) {
+    if (errorString) *errorString = message;
+    return false;
+}
+
+// Hint the kernel to read ahead aggressively and drop pages behind us
+void adviseSequential(uchar *data, qint64 size) {
+#if defined(Q_OS_UNIX)
+    if (data && size > 0)
+        ::madvise(data, static_cast<size_t>(size), MADV_SEQUENTIAL);
+#else
+    Q_UNUSED(data);
+    Q_UNUSED(size);
+#endif
+}
+
+void convertMapped(const uchar *in, uchar *out, std::size_t count,
+                   const ConversionPlan &plan, ElementType type) {
+    WorkStealingPool &pool = WorkStealingPool::global();
+    if (type == ElementType::Float64) {
+        plan.apply(std::span<const double>(reinterpret_cast<const double *>(in), count),
+                   std::span<double>(reinterpret_cast<double *>(out), count), pool);
+    } else {
+        plan.apply(std::span<const float>(reinterpret_cast<const float *>(in), count),
+                   std::span<float>(reinterpret_cast<float *>(out), count), pool);
+    }
+}
+
+bool checkInput(const QFile &file, ElementType type, QString *errorString) {
+#if Q_BYTE_ORDER == Q_BIG_ENDIAN
+    Q_UNUSED(file);
+    Q_UNUSED(type);
+    return fail(errorString, "Little-endian arrays cannot be mapped directly on this host");
+#else
+    if (file.size() % static_cast<qint64>(elementSize(type)) != 0)
+        return fail(errorString, QString("%1 is not a whole number of elements").arg(file.fileName()));
+    return true;
+#endif
+}
+
+} // namespace
+
+std::size_t elementSize(ElementType type) {
+    return type == ElementType::Float64 ? sizeof(double) : sizeof(float);
+}
+
+bool convertFile(const QString &inputPath, const QString &outputPath,
+                 const ConversionPlan &plan, ElementType type, QString *errorString) {
+    if (QFileInfo(inputPath).canonicalFilePath() == QFileInfo(outputPath).canonicalFilePath()
+        && QFileInfo::exists(outputPath))
+        return convertFileInPlace(inputPath, plan, type, errorString);
+
+    QFile input(inputPath);
+    if (!input.open(QIODevice::ReadOnly))
+        return fail(errorString, input.errorString());
+    if (!checkInput(input, type, errorString))
+        return false;
+
+    QFile output(outputPath);
+    if (!output.open(QIODevice::ReadWrite | QIODevice::Truncate))
+        return fail(errorString, output.errorString());
+
+    const qint64 size = input.size();
+    if (size == 0)
+        return true;
+    if (!output.resize(size))
+        return fail(errorString, output.errorString());
+
+    uchar *in = input.map(0, size);
+    if (!in)
+        return fail(errorString, input.errorString());
+    uchar *out = output.map(0, size);
+    if (!out)
+        return fail(errorString, output.errorString());
+
+    adviseSequential(in, size);
+    adviseSequential(out, size);
+
+    convertMapped(in, out, static_cast<std::size_t>(size) / elementSize(type), plan, type);
+
+    output.unmap(out);
+    input.unmap(in);
+    return true;
+}
+
+bool convertFileInPlace(const QString &path, const ConversionPlan &plan,
+                        ElementType type, QString *errorString) {
+    QFile file(path);
+    if (!file.open(QIODevice::ReadWrite))
+        return fail(errorString, file.errorString());
+    if (!checkInput(file, type, errorString))
+        return false;
+
+    const qint64 size = file.size();
+    if (size == 0 || !plan.isValid() || plan.isIdentity())
+        return true;
+
+    uchar *data = file.map(0, size);
+    if (!data)
+        return fail(errorString, file.errorString());
+
+    adviseSequential(data, size);
+    convertMapped(data, data, static_cast<std::size_t>(size) / elementSize(type), plan, type);
+
+    file.unmap(data);
+    return true;
+}
+
+} // namespace MappedConvert
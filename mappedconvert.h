@@ -0,0 +1,32 @@
+#ifndef MAPPEDCONVERT_H
+#define MAPPEDCONVERT_H
+
+#include <QString>
+#include <cstddef>
+
+#include "conversionplan.h"
+
+// Conversion of raw little-endian float/double arrays stored on disk.
+//
+// Files are memory-mapped and converted straight from the input mapping
+// into the output mapping (or in place) by the batch kernels on the shared
+// thread pool. Mappings are advised as sequential, so each page is read
+// once and nothing is copied through intermediate buffers.
+namespace MappedConvert {
+
+enum class ElementType { Float64, Float32 };
+
+std::size_t elementSize(ElementType type);
+
+// Writes the converted array to outputPath, creating or truncating it
+bool convertFile(const QString &inputPath, const QString &outputPath,
+                 const ConversionPlan &plan, ElementType type,
+                 QString *errorString = nullptr);
+
+// Overwrites the array in `path` with its converted values
+bool convertFileInPlace(const QString &path, const ConversionPlan &plan,
+                        ElementType type, QString *errorString = nullptr);
+
+} // namespace MappedConvert
+
+#endif // MAPPEDCONVERT_H
@@ -0,0 +1,136 @@
+#ifndef QUANTITY_H
+#define QUANTITY_H
+
+#include <type_traits>
+
+// Compile-time typed quantities for callers that know their units up front.
+//
+//     Quantities::Quantity<Quantities::Length, Quantities::Meters> m(3.0);
+//     Quantities::Quantity<Quantities::Length, Quantities::Feet> ft = m;
+//
+// Conversion factors are folded at compile time, converting to the same
+// unit is a no-op, and mixing dimensions does not compile. The unit
+// definitions below are also what Units::initConversionFactors registers,
+// so both APIs always agree on the numbers.
+namespace Quantities {
+
+/* ===================== DIMENSIONS ===================== */
+
+struct Length {};
+struct Weight {};
+struct Volume {};
+struct Speed {};
+struct Temperature {};
+
+/* ===================== UNITS ===================== */
+
+// A unit relates to its dimension's base unit as
+// value = base * factor + offset; offset is only non-zero for temperature.
+#define QUANTITY_AFFINE_UNIT(Type, Dim, unitName, unitFactor, unitOffset) \
+    struct Type {                                                         \
+        using dimension = Dim;                                            \
+        static constexpr const char *name = unitName;                     \
+        static constexpr double factor = unitFactor;                      \
+        static constexpr double offset = unitOffset;                      \
+    };
+#define QUANTITY_UNIT(Type, Dim, unitName, unitFactor) \
+    QUANTITY_AFFINE_UNIT(Type, Dim, unitName, unitFactor, 0.0)
+
+// Factors are base units per unit inverted, from the exact definitions
+// UnitCatalog uses (1 ft = 0.3048 m, 1 US gal = 3.785411784 L)
+QUANTITY_UNIT(Meters, Length, "Meters", 1.0)
+QUANTITY_UNIT(Feet, Length, "Feet", 1.0 / 0.3048)
+QUANTITY_UNIT(Kilometers, Length, "Kilometers", 1.0 / 1000.0)
+QUANTITY_UNIT(Miles, Length, "Miles", 1.0 / 1609.344)
+
+QUANTITY_UNIT(Kilograms, Weight, "Kilograms", 1.0)
+QUANTITY_UNIT(Pounds, Weight, "Pounds", 1.0 / 0.45359237)
+
+QUANTITY_UNIT(Liters, Volume, "Liters", 1.0)
+QUANTITY_UNIT(Milliliters, Volume, "Milliliters", 1000.0)
+QUANTITY_UNIT(Gallons, Volume, "Gallons", 1.0 / 3.785411784)
+
+QUANTITY_UNIT(MetersPerSecond, Speed, "m/s", 1.0)
+QUANTITY_UNIT(KilometersPerHour, Speed, "km/h", 3.6)
+QUANTITY_UNIT(MilesPerHour, Speed, "mph", 1.0 / 0.44704)
+
+QUANTITY_AFFINE_UNIT(Celsius, Temperature, "Celsius", 1.0, 0.0)
+QUANTITY_AFFINE_UNIT(Fahrenheit, Temperature, "Fahrenheit", 1.8, 32.0)
+
+#undef QUANTITY_UNIT
+#undef QUANTITY_AFFINE_UNIT
+
+/* ===================== CONVERSION ===================== */
+
+template <class From, class To>
+inline constexpr double scaleFactor = To::factor / From::factor;
+
+template <class From, class To>
+inline constexpr double offsetTerm = To::offset - From::offset * scaleFactor<From, To>;
+
+// Folds to the same affine plan Units::plan builds at runtime, so results
+// are bit-identical with the runtime engine.
+template <class From, class To>
+constexpr double convertValue(double value) {
+    static_assert(std::is_same_v<typename From::dimension, typename To::dimension>,
+                  "cannot convert between different dimensions");
+
+    if constexpr (std::is_same_v<From, To>) {
+        return value;
+    } else if constexpr (offsetTerm<From, To> == 0.0) {
+        return value * scaleFactor<From, To>;
+    } else {
+        return value * scaleFactor<From, To> + offsetTerm<From, To>;
+    }
+}
+
+/* ===================== QUANTITY ===================== */
+
+template <class Dim, class Unit>
+class Quantity
+{
+    static_assert(std::is_same_v<typename Unit::dimension, Dim>,
+                  "unit does not belong to this dimension");
+
+public:
+    using dimension = Dim;
+    using unit = Unit;
+
+    constexpr Quantity() = default;
+    constexpr explicit Quantity(double value) : v(value) {}
+
+    // Implicit only within a dimension; anything else fails to compile
+    template <class OtherUnit>
+    constexpr Quantity(Quantity<Dim, OtherUnit> other)
+        : v(convertValue<OtherUnit, Unit>(other.value())) {}
+
+    constexpr double value() const { return v; }
+
+    template <class To>
+    constexpr Quantity<Dim, To> to() const {
+        return Quantity<Dim, To>(convertValue<Unit, To>(v));
+    }
+
+    constexpr Quantity operator+(Quantity other) const { return Quantity(v + other.v); }
+    constexpr Quantity operator-(Quantity other) const { return Quantity(v - other.v); }
+    constexpr Quantity operator*(double k) const { return Quantity(v * k); }
+    constexpr Quantity operator/(double k) const { return Quantity(v / k); }
+
+    constexpr bool operator==(const Quantity &other) const { return v == other.v; }
+    constexpr bool operator<(const Quantity &other) const { return v < other.v; }
+
+private:
+    double v = 0.0;
+};
+
+template <class Unit>
+using QuantityOf = Quantity<typename Unit::dimension, Unit>;
+
+template <class To, class Dim, class From>
+constexpr Quantity<Dim, To> quantity_cast(Quantity<Dim, From> q) {
+    return q.template to<To>();
+}
+
+} // namespace Quantities
+
+#endif // QUANTITY_H
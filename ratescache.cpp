@@ -0,0 +1,171 @@
+#include "ratescache.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QtEndian>
+
+#include <array>
+#include <cmath>
+#include <cstring>
+
+namespace RatesCache {
+
+namespace {
+
+constexpr char Magic[8] = {'U', 'C', 'R', 'A', 'T', 'E', 'S', '1'};
+constexpr quint32 Format = 1;
+constexpr qsizetype CodeBytes = 8;
+
+// Byte offsets in the header
+constexpr qsizetype FormatAt = 8;
+constexpr qsizetype CrcAt = 12;
+constexpr qsizetype TimeAt = 16;
+constexpr qsizetype CountAt = 24;
+constexpr qsizetype BaseAt = 28;
+constexpr qsizetype HeaderBytes = 32;
+constexpr qsizetype RecordBytes = CodeBytes + sizeof(double);
+
+// Far above any real provider; bounds what a damaged count can claim
+constexpr quint32 MaxCurrencies = 1u << 16;
+
+/* ===================== CRC-32 ===================== */
+
+constexpr std::array<quint32, 256> makeCrcTable() {
+    std::array<quint32, 256> table{};
+    for (quint32 i = 0; i < 256; ++i) {
+        quint32 c = i;
+        for (int k = 0; k < 8; ++k)
+            c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+        table[i] = c;
+    }
+    return table;
+}
+
+constexpr std::array<quint32, 256> CrcTable = makeCrcTable();
+
+quint32 crc32(const uchar *data, qsizetype size) {
+    quint32 c = 0xFFFFFFFFu;
+    for (qsizetype i = 0; i < size; ++i)
+        c = CrcTable[(c ^ data[i]) & 0xFF] ^ (c >> 8);
+    return c ^ 0xFFFFFFFFu;
+}
+
+template <typename T>
+T readAt(const uchar *p, qsizetype at) {
+    return qFromLittleEndian<T>(p + at);
+}
+
+template <typename T>
+void writeAt(uchar *p, qsizetype at, T value) {
+    qToLittleEndian<T>(value, p + at);
+}
+
+} // namespace
+
+QString defaultPath() {
+    return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/rates.bin";
+}
+
+/* ===================== LOAD ===================== */
+
+Status load(const QString &path, RateSnapshot &snapshot, QDateTime &fetchedAt) {
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly))
+        return Status::Missing;
+
+    const qint64 size = file.size();
+    if (size < HeaderBytes)
+        return Status::Corrupt;
+    const uchar *p = file.map(0, size);
+    if (!p)
+        return Status::Corrupt;
+
+    const quint32 count = readAt<quint32>(p, CountAt);
+    const quint32 baseIndex = readAt<quint32>(p, BaseAt);
+    const bool intact = std::memcmp(p, Magic, sizeof(Magic)) == 0
+                        && readAt<quint32>(p, FormatAt) == Format
+                        && count > 0 && count <= MaxCurrencies && baseIndex < count
+                        && size == HeaderBytes + qint64(count) * RecordBytes
+                        && readAt<quint32>(p, CrcAt) == crc32(p + TimeAt, size - TimeAt);
+    if (!intact) {
+        file.unmap(const_cast<uchar *>(p));
+        return Status::Corrupt;
+    }
+
+    auto codeAt = [p](quint32 i) {
+        const char *code = reinterpret_cast<const char *>(p + HeaderBytes + qsizetype(i) * RecordBytes);
+        return QString::fromLatin1(code, qsizetype(strnlen(code, CodeBytes)));
+    };
+    auto rateAt = [p](quint32 i) {
+        return readAt<double>(p, HeaderBytes + qsizetype(i) * RecordBytes + CodeBytes);
+    };
+
+    RateSnapshot loaded;
+    loaded.reserve(count);
+    loaded.setBase(codeAt(baseIndex));
+    for (quint32 i = 0; i < count; ++i) {
+        const double rate = rateAt(i);
+        if (!(rate > 0.0) || !std::isfinite(rate)) {
+            file.unmap(const_cast<uchar *>(p));
+            return Status::Corrupt;
+        }
+        if (i != baseIndex)
+            loaded.setBaseRate(codeAt(i), rate);
+    }
+    const qint64 ms = readAt<qint64>(p, TimeAt);
+    file.unmap(const_cast<uchar *>(p));
+
+    snapshot = std::move(loaded);
+    fetchedAt = QDateTime::fromMSecsSinceEpoch(ms).toUTC();
+    return Status::Ok;
+}
+
+/* ===================== SAVE ===================== */
+
+bool save(const QString &path, const RateSnapshot &snapshot, const QDateTime &fetchedAt) {
+    const std::uint32_t baseSlot = snapshot.currencyIndex(snapshot.base());
+    if (baseSlot == RateSnapshot::npos || snapshot.base().toLatin1().size() > CodeBytes)
+        return false;
+
+    QByteArray data(HeaderBytes + qsizetype(snapshot.size()) * RecordBytes, '\0');
+    uchar *p = reinterpret_cast<uchar *>(data.data());
+
+    // Codes that do not fit a record are left out; no provider uses them
+    quint32 count = 0;
+    quint32 baseIndex = 0;
+    for (std::uint32_t i = 0; i < snapshot.size(); ++i) {
+        const QByteArray code = snapshot.currencyCode(i).toLatin1();
+        if (code.isEmpty() || code.size() > CodeBytes)
+            continue;
+        if (i == baseSlot)
+            baseIndex = count;
+        uchar *record = p + HeaderBytes + qsizetype(count) * RecordBytes;
+        std::memcpy(record, code.constData(), size_t(code.size()));
+        writeAt<double>(record, CodeBytes, snapshot.baseRate(i));
+        ++count;
+    }
+    data.truncate(HeaderBytes + qsizetype(count) * RecordBytes);
+    p = reinterpret_cast<uchar *>(data.data());
+
+    std::memcpy(p, Magic, sizeof(Magic));
+    writeAt<quint32>(p, FormatAt, Format);
+    writeAt<qint64>(p, TimeAt, fetchedAt.toMSecsSinceEpoch());
+    writeAt<quint32>(p, CountAt, count);
+    writeAt<quint32>(p, BaseAt, baseIndex);
+    writeAt<quint32>(p, CrcAt, crc32(p + TimeAt, data.size() - TimeAt));
+
+    QDir().mkpath(QFileInfo(path).absolutePath());
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly))
+        return false;
+    if (file.write(data) != data.size()) {
+        file.cancelWriting();
+        return false;
+    }
+    return file.commit();
+}
+
+} // namespace RatesCache
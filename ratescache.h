@@ -0,0 +1,32 @@
+#ifndef RATESCACHE_H
+#define RATESCACHE_H
+
+#include <QDateTime>
+#include <QString>
+
+#include "ratesnapshot.h"
+
+// The last good rate set, kept on disk so currency conversion works as soon
+// as the app starts instead of after the first download.
+//
+// File layout (little-endian, 16-byte records):
+//     header   magic "UCRATES1", format, CRC-32 of everything after it,
+//              fetch time (ms since epoch, UTC), count, base index
+//     records  count x { code (up to 8 ASCII bytes, NUL padded), perBase }
+//
+// load() maps the file and checks size, magic and checksum before building
+// the snapshot, so a torn or foreign file is reported as Corrupt, never
+// half-used. save() replaces the file atomically.
+namespace RatesCache {
+
+enum class Status { Ok, Missing, Corrupt };
+
+// <cache dir>/rates.bin
+QString defaultPath();
+
+Status load(const QString &path, RateSnapshot &snapshot, QDateTime &fetchedAt);
+bool save(const QString &path, const RateSnapshot &snapshot, const QDateTime &fetchedAt);
+
+} // namespace RatesCache
+
+#endif // RATESCACHE_H
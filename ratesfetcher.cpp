@@ -0,0 +1,377 @@
+#include "ratesfetcher.h"
+#include "ratescache.h"
+#include "trace.h"
+#include "units.h"
+
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QNetworkRequest>
+#include <QTimer>
+#include <QUrl>
+#include <QUrlQuery>
+
+#include <algorithm>
+#include <cmath>
+
+// Bytes pulled from a rates reply per read; also caps its socket buffer
+static constexpr qint64 ReadChunk = 16 * 1024;
+
+QList<RatesFetcher::Provider> RatesFetcher::defaultProviders()
+{
+    return {
+        {"exchangerate.host", "https://api.exchangerate.host/latest"},
+        {"frankfurter", "https://api.frankfurter.app/latest?from={base}"},
+        {"open.er-api", "https://open.er-api.com/v6/latest/{base}"},
+    };
+}
+
+QList<RatesFetcher::Provider> RatesFetcher::providersFromString(const QString &urls)
+{
+    QList<Provider> list;
+    for (const QString &part : urls.split(',', Qt::SkipEmptyParts)) {
+        const QString url = part.trimmed();
+        const QUrl parsed(url);
+        const QString name = parsed.port() > 0 ? parsed.host() + ':' + QString::number(parsed.port()) : parsed.host();
+        list.append({name.isEmpty() ? url : name, url});
+    }
+    return list;
+}
+
+RatesFetcher::RatesFetcher(QObject *parent)
+    : RatesFetcher(Settings{}, parent)
+{
+}
+
+RatesFetcher::RatesFetcher(const Settings &settings, QObject *parent)
+    : QObject(parent), settings(settings), providers(settings.providers.size())
+{
+}
+
+RatesFetcher::~RatesFetcher() = default;
+
+void RatesFetcher::start()
+{
+    if (networkManager) return;
+
+    loadCache();
+
+    clock.start();
+    networkManager = new QNetworkAccessManager(this);
+    refreshTimer = new QTimer(this);
+    timeoutTimer = new QTimer(this);
+    timeoutTimer->setSingleShot(true);
+    hedgeTimer = new QTimer(this);
+    hedgeTimer->setSingleShot(true);
+
+    connect(networkManager, &QNetworkAccessManager::finished, this, &RatesFetcher::onFinished);
+    connect(refreshTimer, &QTimer::timeout, this, &RatesFetcher::fetchRates);
+    connect(timeoutTimer, &QTimer::timeout, this, &RatesFetcher::onTimeout);
+    connect(hedgeTimer, &QTimer::timeout, this, &RatesFetcher::onHedge);
+
+    refreshTimer->start(settings.refreshIntervalSeconds * 1000);
+    fetchRates();
+}
+
+// Publishes the saved rates unless something newer is already in place
+void RatesFetcher::loadCache()
+{
+    if (settings.cachePath.isEmpty()) return;
+    TRACE_SCOPE("rates.cache.load");
+
+    RateSnapshot snapshot;
+    QDateTime fetchedAt;
+    if (RatesCache::load(settings.cachePath, snapshot, fetchedAt) != RatesCache::Status::Ok) return;
+    if (!Units::getInstance().rateSnapshot()->isEmpty()) return;
+
+    const int currencies = static_cast<int>(snapshot.size());
+    const std::uint64_t version = Units::getInstance().publishRates(std::move(snapshot));
+    emit cachedRatesLoaded(version, currencies, fetchedAt);
+}
+
+/* ===================== REQUEST ===================== */
+
+void RatesFetcher::fetchRates()
+{
+    if (!networkManager || fetching) return;
+
+    fetching = true;
+    traceFetchId = ++traceSequence;
+    traceFetchBegin = Trace::now();
+    nextProvider = 0;
+    lastFailure = Failure::Network;
+    emit fetchStarted();
+
+    if (!launchNext()) {
+        endFetch();     // every provider's breaker is open
+        emit fetchFailed(Failure::Network);
+        return;
+    }
+    timeoutTimer->start(settings.requestTimeoutMs);
+}
+
+// Asks the next available provider in preference order and arms the hedge
+// for it; false when none is left
+bool RatesFetcher::launchNext()
+{
+    while (nextProvider < static_cast<int>(providers.size()) && !isAvailable(nextProvider))
+        ++nextProvider;
+    if (nextProvider >= static_cast<int>(providers.size()))
+        return false;
+
+    const int index = nextProvider++;
+    ProviderState &state = providers[index];
+    if (state.openUntilMs != 0) state.trialInFlight = true;     // half-open
+
+    const Provider &provider = settings.providers[index];
+    QUrl url;
+    if (provider.url.contains("{base}")) {
+        url = QUrl(QString(provider.url).replace("{base}", settings.baseCurrency));
+    } else {
+        url = QUrl(provider.url);
+        QUrlQuery q(url);
+        q.addQueryItem("base", settings.baseCurrency);
+        url.setQuery(q);
+    }
+
+    // Accept-Encoding is left to QNetworkAccessManager: it advertises the
+    // encodings it can decode (gzip, deflate, plus brotli/zstd where Qt was
+    // built with them) and decompresses transparently, which it stops
+    // doing once the header is set by hand
+    QNetworkRequest request(url);
+    if (!state.etag.isEmpty()) request.setRawHeader("If-None-Match", state.etag);
+    if (!state.lastModified.isEmpty()) request.setRawHeader("If-Modified-Since", state.lastModified);
+
+    Attempt attempt;
+    attempt.reply = networkManager->get(request);
+    attempt.reply->setReadBufferSize(ReadChunk);
+    attempt.provider = index;
+    attempt.parser = std::make_unique<RatesPayload::StreamParser>();
+    attempt.started.start();
+    connect(attempt.reply, &QNetworkReply::readyRead, this, &RatesFetcher::onReadyRead);
+    if (Trace::isEnabled()) traceAttempt(attempt);
+    attempts.push_back(std::move(attempt));
+
+    hedgeTimer->start(hedgeDelayMs(index));
+    return true;
+}
+
+// Request span, with the TLS handshake and first response headers marked
+// as phases of it; connected only while tracing
+void RatesFetcher::traceAttempt(Attempt &attempt)
+{
+    const std::uint64_t id = ++traceSequence;
+    const std::uint64_t begin = Trace::now();
+    attempt.traceId = id;
+    attempt.traceBegin = begin;
+
+    connect(attempt.reply, &QNetworkReply::encrypted, this, [id, begin]() {
+        Trace::async("net.tls", id, begin, Trace::now());
+    });
+    connect(attempt.reply, &QNetworkReply::metaDataChanged, this, [id, begin, done = false]() mutable {
+        if (done) return;
+        done = true;
+        Trace::async("net.headers", id, begin, Trace::now());
+    });
+}
+
+void RatesFetcher::onHedge()
+{
+    if (fetching && static_cast<int>(attempts.size()) < settings.maxInFlight)
+        launchNext();
+}
+
+void RatesFetcher::onReadyRead()
+{
+    for (Attempt &attempt : attempts) {
+        if (attempt.reply == sender()) {
+            drainReply(attempt);
+            return;
+        }
+    }
+}
+
+// Parses the payload while it downloads, one bounded chunk at a time
+void RatesFetcher::drainReply(Attempt &attempt)
+{
+    TRACE_SCOPE("rates.parse");
+    char chunk[ReadChunk];
+    qint64 n;
+    while ((n = attempt.reply->read(chunk, sizeof(chunk))) > 0) {
+        if (!attempt.parser->feed(QByteArrayView(chunk, n))) {
+            attempt.reply->readAll();   // invalid already; drop the rest
+            return;
+        }
+    }
+}
+
+// Drops every attempt still in flight; their finished() is then ignored
+void RatesFetcher::abandonAttempts(bool countAsFailures)
+{
+    std::vector<Attempt> abandoned = std::move(attempts);
+    attempts.clear();
+    for (Attempt &attempt : abandoned) {
+        if (countAsFailures) recordFailure(attempt.provider);
+        else providers[attempt.provider].trialInFlight = false;
+        if (attempt.traceId) Trace::async("net.request", attempt.traceId, attempt.traceBegin, Trace::now());
+        attempt.reply->abort();
+    }
+}
+
+void RatesFetcher::endFetch()
+{
+    fetching = false;
+    Trace::async("rates.fetch", traceFetchId, traceFetchBegin, Trace::now());
+    timeoutTimer->stop();
+    hedgeTimer->stop();
+}
+
+/* ===================== COMPLETION ===================== */
+
+void RatesFetcher::onFinished(QNetworkReply *reply)
+{
+    reply->deleteLater();
+    auto it = std::find_if(attempts.begin(), attempts.end(),
+                           [reply](const Attempt &a) { return a.reply == reply; });
+    if (it == attempts.end()) return;   // abandoned
+
+    Attempt attempt = std::move(*it);
+    attempts.erase(it);
+    const int latencyMs = static_cast<int>(attempt.started.elapsed());
+    if (attempt.traceId) Trace::async("net.request", attempt.traceId, attempt.traceBegin, Trace::now());
+
+    // Failure: move on to the next provider now rather than at the hedge
+    auto failed = [&](Failure reason) {
+        recordFailure(attempt.provider);
+        lastFailure = reason;
+        if (!launchNext() && attempts.empty()) {
+            endFetch();
+            emit fetchFailed(lastFailure);
+        }
+    };
+
+    if (reply->error() != QNetworkReply::NoError) {
+        failed(Failure::Network);
+        return;
+    }
+
+    // Not modified: the published rates are current, nothing to parse
+    if (reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt() == 304) {
+        recordSuccess(attempt.provider, latencyMs);
+        abandonAttempts(false);
+        endFetch();
+        saveCache();
+        emit ratesUnchanged(settings.providers[attempt.provider].name);
+        return;
+    }
+
+    drainReply(attempt);    // whatever arrived after the last readyRead
+    RatesPayload::Status status;
+    {
+        TRACE_SCOPE("rates.parse.finish");
+        status = attempt.parser->finish();
+    }
+    switch (status) {
+    case RatesPayload::Status::Invalid:
+        failed(Failure::Invalid);
+        return;
+    case RatesPayload::Status::Empty:
+        failed(Failure::Empty);
+        return;
+    case RatesPayload::Status::Ok:
+        break;
+    }
+
+    // First valid answer wins; the others are cancelled. Their latency is
+    // not recorded, as it is only a lower bound
+    recordSuccess(attempt.provider, latencyMs);
+    ProviderState &state = providers[attempt.provider];
+    state.etag = reply->rawHeader("ETag");
+    state.lastModified = reply->rawHeader("Last-Modified");
+    abandonAttempts(false);
+    endFetch();
+    publish(attempt.parser->takeSnapshot(), attempt.provider);
+}
+
+void RatesFetcher::publish(RateSnapshot snapshot, int provider)
+{
+    TRACE_SCOPE("rates.publish");
+    const QString &name = settings.providers[provider].name;
+
+    // Same rates as published: keep the current snapshot (and its
+    // version) instead of swapping in an identical one
+    const RateSnapshotPtr current = Units::getInstance().rateSnapshot();
+    const std::size_t changed = snapshot.changedRates(*current);
+    if (changed == 0 && !current->isEmpty()) {
+        saveCache();
+        emit ratesUnchanged(name);
+        return;
+    }
+
+    const int currencies = static_cast<int>(snapshot.size());
+    const std::uint64_t version = Units::getInstance().publishRates(std::move(snapshot));
+    emit ratesPublished(version, currencies, static_cast<int>(changed), name);
+    saveCache();
+}
+
+void RatesFetcher::onTimeout()
+{
+    if (!fetching) return;
+
+    abandonAttempts(true);
+    endFetch();
+    emit fetchFailed(Failure::Timeout);
+}
+
+/* ===================== PROVIDER HEALTH ===================== */
+
+bool RatesFetcher::isAvailable(int provider) const
+{
+    const ProviderState &state = providers[provider];
+    if (state.openUntilMs == 0) return true;
+    return clock.elapsed() >= state.openUntilMs && !state.trialInFlight;
+}
+
+int RatesFetcher::hedgeDelayMs(int provider) const
+{
+    const ProviderState &state = providers[provider];
+    if (state.samples < ProviderState::MinSamples)
+        return settings.hedgeDefaultMs;
+
+    const int count = std::min(state.samples, ProviderState::Window);
+    std::array<int, ProviderState::Window> sorted = state.latencyMs;
+    const int rank = std::clamp(static_cast<int>(std::ceil(settings.hedgePercentile * count)) - 1, 0, count - 1);
+    std::nth_element(sorted.begin(), sorted.begin() + rank, sorted.begin() + count);
+    return std::clamp(sorted[rank], settings.hedgeMinMs, settings.requestTimeoutMs);
+}
+
+void RatesFetcher::recordSuccess(int provider, int latencyMs)
+{
+    ProviderState &state = providers[provider];
+    state.latencyMs[state.samples % ProviderState::Window] = latencyMs;
+    ++state.samples;
+    state.consecutiveFailures = 0;
+    state.openUntilMs = 0;
+    state.trialInFlight = false;
+}
+
+void RatesFetcher::recordFailure(int provider)
+{
+    ProviderState &state = providers[provider];
+    ++state.consecutiveFailures;
+    if (state.trialInFlight || state.consecutiveFailures >= settings.breakerFailures)
+        state.openUntilMs = clock.elapsed() + settings.breakerCooldownMs;
+    state.trialInFlight = false;
+}
+
+/* ===================== CACHE ===================== */
+
+// Rewrites the cache with the published rates, stamped as fetched now
+void RatesFetcher::saveCache()
+{
+    if (settings.cachePath.isEmpty()) return;
+    TRACE_SCOPE("rates.cache.save");
+
+    const RateSnapshotPtr published = Units::getInstance().rateSnapshot();
+    if (!published->isEmpty())
+        RatesCache::save(settings.cachePath, *published, QDateTime::currentDateTimeUtc());
+}
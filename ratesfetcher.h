@@ -0,0 +1,164 @@
+#ifndef RATESFETCHER_H
+#define RATESFETCHER_H
+
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QList>
+#include <QObject>
+#include <QString>
+#include <array>
+#include <memory>
+#include <vector>
+
+#include "ratespayload.h"
+
+class QNetworkAccessManager;
+class QNetworkReply;
+class QTimer;
+
+// Downloads, parses and publishes currency rates away from the GUI thread.
+//
+// Move the fetcher to its own QThread and call start() there (e.g. from
+// QThread::started); from then on it owns its network manager, refresh
+// and timeout timers and the stream parsers, all on that thread. Each good
+// payload is published to Units as a complete snapshot from the worker
+// thread, and the outcome is reported through signals, which reach GUI
+// receivers queued. The GUI thread never touches a reply or a byte of
+// JSON.
+//
+// With a cachePath, start() first publishes the rates saved by the last
+// good fetch (see RatesCache) and every good fetch rewrites the file, so
+// conversions work before the network answers.
+//
+// Refreshes are conditional: the validators of the last good response go
+// out as If-None-Match / If-Modified-Since, and a 304 is not parsed at
+// all. A full response whose rates equal the published ones is dropped
+// too, so an unchanged refresh never bumps the rates version.
+//
+// Providers are asked in order. When the one asked last has not answered
+// within hedgePercentile of its recent latencies, the next one is asked
+// as well, and the first valid answer wins; a failed answer moves on to
+// the next provider at once. A provider that fails breakerFailures times
+// in a row is skipped for breakerCooldownMs, then given one trial request.
+class RatesFetcher : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum class Failure { Network, Timeout, Invalid, Empty };
+    Q_ENUM(Failure)
+
+    struct Provider {
+        QString name;
+        QString url;    // "{base}" is replaced; otherwise ?base= is appended
+    };
+
+    struct Settings {
+        QList<Provider> providers = defaultProviders();
+        QString baseCurrency = "USD";
+        int refreshIntervalSeconds = 3600;
+        int requestTimeoutMs = 8000;        // whole fetch, across providers
+        QString cachePath;                  // empty: no on-disk cache
+
+        double hedgePercentile = 0.95;
+        int hedgeMinMs = 100;
+        int hedgeDefaultMs = 1500;          // until a provider has history
+        int maxInFlight = 2;
+
+        int breakerFailures = 3;
+        int breakerCooldownMs = 60000;
+    };
+
+    static QList<Provider> defaultProviders();
+
+    // Comma-separated URLs, e.g. from an environment variable; each is
+    // named after its host and port
+    static QList<Provider> providersFromString(const QString &urls);
+
+    explicit RatesFetcher(QObject *parent = nullptr);
+    explicit RatesFetcher(const Settings &settings, QObject *parent = nullptr);
+    ~RatesFetcher() override;
+
+public slots:
+    // Loads the cache, creates the network objects, starts the refresh
+    // timer and fetches once
+    void start();
+
+    // Does nothing while a fetch is already in flight
+    void fetchRates();
+
+signals:
+    void cachedRatesLoaded(quint64 version, int currencies, QDateTime fetchedAt);
+    void fetchStarted();
+    void ratesPublished(quint64 version, int currencies, int changed, const QString &provider);
+    void ratesUnchanged(const QString &provider);
+    void fetchFailed(RatesFetcher::Failure reason);
+
+private:
+    // Per-provider history: recent latencies, breaker state, validators
+    struct ProviderState {
+        static constexpr int Window = 32;
+        static constexpr int MinSamples = 8;
+
+        std::array<int, Window> latencyMs{};
+        int samples = 0;
+        int consecutiveFailures = 0;
+        qint64 openUntilMs = 0;     // breaker open until then; 0 = closed
+        bool trialInFlight = false;
+
+        QByteArray etag;
+        QByteArray lastModified;
+    };
+
+    // One request of the current fetch
+    struct Attempt {
+        QNetworkReply *reply = nullptr;
+        int provider = 0;
+        std::unique_ptr<RatesPayload::StreamParser> parser;
+        QElapsedTimer started;
+        std::uint64_t traceId = 0;
+        std::uint64_t traceBegin = 0;
+    };
+
+    bool launchNext();
+    void onHedge();
+    void onReadyRead();
+    void onFinished(QNetworkReply *reply);
+    void onTimeout();
+    void drainReply(Attempt &attempt);
+    void abandonAttempts(bool countAsFailures);
+    void endFetch();
+    void traceAttempt(Attempt &attempt);
+    void publish(RateSnapshot snapshot, int provider);
+
+    bool isAvailable(int provider) const;
+    int hedgeDelayMs(int provider) const;
+    void recordSuccess(int provider, int latencyMs);
+    void recordFailure(int provider);
+
+    void loadCache();
+    void saveCache();
+
+    Settings settings;
+
+    QNetworkAccessManager *networkManager = nullptr;
+    QTimer *refreshTimer = nullptr;
+    QTimer *timeoutTimer = nullptr;
+    QTimer *hedgeTimer = nullptr;
+    QElapsedTimer clock;
+
+    std::vector<ProviderState> providers;
+
+    // The fetch in progress; replies from abandoned attempts are ignored
+    bool fetching = false;
+    int nextProvider = 0;
+    Failure lastFailure = Failure::Network;
+    std::vector<Attempt> attempts;
+
+    // Trace span of the fetch in progress; ids are shared with requests
+    std::uint64_t traceFetchId = 0;
+    std::uint64_t traceFetchBegin = 0;
+    std::uint64_t traceSequence = 0;
+};
+
+#endif // RATESFETCHER_H
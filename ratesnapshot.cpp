@@ -0,0 +1,121 @@
+#include "ratesnapshot.h"
+
+#include <algorithm>
+#include <limits>
+
+/* ===================== BUILDING ===================== */
+
+void RateSnapshot::reserve(std::size_t count) {
+    codes.reserve(count);
+    perBase.reserve(count);
+    index.reserve(count);
+}
+
+std::uint32_t RateSnapshot::insert(const QString &code, double rate) {
+    auto it = index.find(code);
+    if (it != index.end()) {
+        perBase[it->second] = rate;
+        return it->second;
+    }
+
+    const std::uint32_t slot = static_cast<std::uint32_t>(codes.size());
+    codes.push_back(code);
+    perBase.push_back(rate);
+    index.emplace(code, slot);
+    return slot;
+}
+
+void RateSnapshot::setBase(const QString &code) {
+    baseCode = code;
+    insert(code, 1.0);
+}
+
+void RateSnapshot::setBaseRate(const QString &code, double rate) {
+    if (codes.empty() && baseCode.isEmpty())
+        setBase(code);
+    insert(code, rate);
+}
+
+// Swaps the last currency into the freed index; only valid before publish
+void RateSnapshot::removeCurrency(const QString &code) {
+    auto it = index.find(code);
+    if (it == index.end())
+        return;
+
+    const std::uint32_t slot = it->second;
+    index.erase(it);
+    if (slot + 1 != codes.size()) {
+        codes[slot] = std::move(codes.back());
+        perBase[slot] = perBase.back();
+        index[codes[slot]] = slot;
+    }
+    codes.pop_back();
+    perBase.pop_back();
+    if (baseCode == code)
+        baseCode.clear();
+}
+
+bool RateSnapshot::setRate(const QString &from, const QString &to, double rate) {
+    if (!(rate > 0.0 && rate < std::numeric_limits<double>::infinity()) || from == to)
+        return false;
+
+    const std::uint32_t a = currencyIndex(from);
+    const std::uint32_t b = currencyIndex(to);
+
+    if (a == npos && b == npos) {
+        // An unrelated pair has no rate against the base to derive
+        if (!codes.empty())
+            return false;
+        setBase(from);
+        insert(to, rate);
+    } else if (b == npos || (a != npos && to != baseCode)) {
+        insert(to, perBase[a] * rate);
+    } else {
+        insert(from, perBase[b] / rate);
+    }
+    return true;
+}
+
+/* ===================== LOOKUP ===================== */
+
+std::uint32_t RateSnapshot::currencyIndex(const QString &code) const {
+    auto it = index.find(code);
+    return it != index.end() ? it->second : npos;
+}
+
+std::size_t RateSnapshot::changedRates(const RateSnapshot &previous) const {
+    if (baseCode != previous.baseCode)
+        return std::max(size(), previous.size());
+
+    std::size_t changed = 0;
+    std::size_t matched = 0;
+    for (std::uint32_t i = 0; i < codes.size(); ++i) {
+        const std::uint32_t j = previous.currencyIndex(codes[i]);
+        if (j == npos) {
+            ++changed;
+            continue;
+        }
+        ++matched;
+        if (previous.perBase[j] != perBase[i])
+            ++changed;
+    }
+    return changed + (previous.size() - matched);
+}
+
+bool RateSnapshot::rate(const QString &from, const QString &to, double &outRate) const {
+    const std::uint32_t a = currencyIndex(from);
+    if (a == npos)
+        return false;
+
+    const std::uint32_t b = currencyIndex(to);
+    if (b == npos)
+        return false;
+
+    const double ra = perBase[a];
+    const double rb = perBase[b];
+    if (!(ra > 0.0 && rb > 0.0))
+        return false;
+
+    outRate = rb / ra;
+    return true;
+}
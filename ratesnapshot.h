@@ -0,0 +1,77 @@
+#ifndef RATESNAPSHOT_H
+#define RATESNAPSHOT_H
+
+#include <QString>
+#include <unordered_map>
+#include <vector>
+#include <memory>
+#include <cstdint>
+
+// One complete, versioned set of currency rates.
+//
+// Rates are stored once per currency, relative to a base currency
+// (1 base = baseRate(i) units of currency i), so a payload of N currencies
+// costs N entries. Cross rates are derived on demand as rate_b / rate_a.
+//
+// A snapshot is filled in while it is private to its writer and is never
+// modified again once Units::publishRates() hands it out. Readers that
+// hold a RateSnapshotPtr therefore see one consistent rate set for as long
+// as they keep it, even while a refresh publishes a newer version.
+// Units hands out references with shared_from_this(), so snapshots are
+// always owned by a RateSnapshotPtr once published.
+class RateSnapshot : public std::enable_shared_from_this<RateSnapshot>
+{
+public:
+    static constexpr std::uint32_t npos = UINT32_MAX;
+
+    std::uint64_t version() const { return ver; }
+    bool isEmpty() const { return codes.empty(); }
+    std::size_t size() const { return codes.size(); }
+    const QString &base() const { return baseCode; }
+
+    // -------- building --------
+    void reserve(std::size_t count);
+    void setBase(const QString &code);
+    void setBaseRate(const QString &code, double perBase);
+    void removeCurrency(const QString &code);
+
+    // Pairwise update, expressed relative to whichever side is already
+    // known; with two known currencies the one that is not the base moves.
+    // False, and nothing stored, for a pair with no known currency (unless
+    // the snapshot is empty: `from` then becomes the base), for from == to
+    // and for rates that are not positive and finite.
+    bool setRate(const QString &from, const QString &to, double rate);
+
+    // -------- lookup --------
+    bool rate(const QString &from, const QString &to, double &outRate) const;
+
+    std::uint32_t currencyIndex(const QString &code) const;
+
+    // Currencies whose rate differs from `previous`, counting ones added
+    // or removed; 0 means publishing this snapshot would change nothing
+    std::size_t changedRates(const RateSnapshot &previous) const;
+    const QString &currencyCode(std::uint32_t index) const { return codes[index]; }
+    double baseRate(std::uint32_t index) const { return perBase[index]; }
+
+    // Snapshot index for the currency unit with the given category index,
+    // or npos. Filled in by Units::publishRates.
+    std::uint32_t unitSlot(std::uint32_t categoryIndex) const {
+        return categoryIndex < unitSlots.size() ? unitSlots[categoryIndex] : npos;
+    }
+
+private:
+    friend class Units;     // stamps the version and unit slots on publish
+
+    std::uint32_t insert(const QString &code, double perBase);
+
+    std::uint64_t ver = 0;
+    QString baseCode;
+    std::vector<QString> codes;                         // by currency index
+    std::vector<double> perBase;                        // by currency index
+    std::unordered_map<QString, std::uint32_t> index;   // code -> currency index
+    std::vector<std::uint32_t> unitSlots;               // currency unit -> index
+};
+
+using RateSnapshotPtr = std::shared_ptr<const RateSnapshot>;
+
+#endif // RATESNAPSHOT_H
@@ -0,0 +1,278 @@
+#include "ratespayload.h"
+
+#include <QFile>
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+
+namespace RatesPayload {
+
+Status parse(const QByteArray &json, RateSnapshot &snapshot) {
+    StreamParser parser;
+    parser.feed(json);
+    const Status status = parser.finish();
+    if (status == Status::Ok)
+        snapshot = parser.takeSnapshot();
+    return status;
+}
+
+Status load(const QString &path, RateSnapshot &snapshot) {
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly))
+        return Status::Invalid;
+    return parse(file.readAll(), snapshot);
+}
+
+/* ===================== STREAM PARSER: LEXER ===================== */
+
+namespace {
+
+bool isSpace(char c) { return c == ' ' || c == '\n' || c == '\r' || c == '\t'; }
+bool isNumberChar(char c) { return (c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E'; }
+bool isLiteralChar(char c) { return c >= 'a' && c <= 'z'; }
+
+} // namespace
+
+bool StreamParser::feed(QByteArrayView chunk) {
+    const char *p = chunk.data();
+    const std::size_t n = static_cast<std::size_t>(chunk.size());
+    std::size_t i = 0;
+    std::size_t tokenStart = 0;     // a token carried over continues at 0
+
+    // Copies the part of a token in this chunk into `carry`, as far as it fits
+    auto spill = [this](const char *from, std::size_t len) {
+        const std::size_t room = MaxToken - carryLen;
+        if (len > room) truncated = true;
+        std::memcpy(carry.data() + carryLen, from, std::min(len, room));
+        carryLen += std::min(len, room);
+        spilled = true;
+    };
+    // The whole token: in place when it lies within this chunk. One longer
+    // than `carry` counts as truncated either way, so where the chunks
+    // happen to split never changes the result.
+    auto take = [&](std::size_t end) -> std::string_view {
+        if (!spilled) {
+            if (end - tokenStart > MaxToken) truncated = true;
+            return std::string_view(p + tokenStart, end - tokenStart);
+        }
+        spill(p + tokenStart, end - tokenStart);
+        return std::string_view(carry.data(), carryLen);
+    };
+    auto beginToken = [&](Lex kind, std::size_t start) {
+        lex = kind;
+        tokenStart = start;
+        escape = escaped = spilled = truncated = false;
+        carryLen = 0;
+    };
+
+    while (i < n && !invalid) {
+        switch (lex) {
+        case Lex::Between: {
+            const char c = p[i];
+            if (isSpace(c)) {
+                ++i;
+            } else if (state == Expect::Done) {
+                fail();     // anything after the top-level object
+            } else if (c == '"') {
+                beginToken(Lex::String, ++i);
+            } else if (c == '-' || (c >= '0' && c <= '9')) {
+                beginToken(Lex::Number, i);
+            } else if (isLiteralChar(c)) {
+                beginToken(Lex::Literal, i);
+            } else {
+                punct(c);
+                ++i;
+            }
+            break;
+        }
+
+        case Lex::String: {
+            std::size_t j = i;
+            for (; j < n; ++j) {
+                const char c = p[j];
+                if (escape) { escape = false; continue; }
+                if (c == '\\') { escape = escaped = true; continue; }
+                if (c == '"') break;
+                if (static_cast<unsigned char>(c) < 0x20) { fail(); break; }
+            }
+            if (invalid) break;
+            if (j == n) {
+                spill(p + tokenStart, n - tokenStart);
+                i = n;
+                break;
+            }
+            const std::string_view text = take(j);
+            lex = Lex::Between;
+            i = j + 1;
+            string(text, escaped);
+            break;
+        }
+
+        case Lex::Number:
+        case Lex::Literal: {
+            const bool number = lex == Lex::Number;
+            std::size_t j = i;
+            while (j < n && (number ? isNumberChar(p[j]) : isLiteralChar(p[j]))) ++j;
+            if (j == n) {
+                spill(p + tokenStart, n - tokenStart);
+                i = n;
+                break;
+            }
+            const std::string_view text = take(j);
+            lex = Lex::Between;
+            i = j;
+            scalar(text, number);
+            break;
+        }
+        }
+    }
+    return !invalid;
+}
+
+/* ===================== STREAM PARSER: GRAMMAR ===================== */
+
+bool StreamParser::beginValue() {
+    if (state != Expect::Value && state != Expect::ValueOrEnd) {
+        fail();
+        return false;
+    }
+    return true;
+}
+
+void StreamParser::endValue() {
+    state = depth == 0 ? Expect::Done : Expect::CommaOrEnd;
+}
+
+void StreamParser::punct(char c) {
+    switch (c) {
+    case '{':
+    case '[':
+        if (!beginValue()) return;
+        if (depth == MaxDepth || (depth == 0 && c != '{')) {
+            fail();     // too deep, or the document is not an object
+            return;
+        }
+        stack[depth] = {c == '{', c == '{' && depth == 1 && topKey == TopKey::Rates};
+        ++depth;
+        state = c == '{' ? Expect::KeyOrEnd : Expect::ValueOrEnd;
+        return;
+
+    case '}':
+    case ']': {
+        const bool object = c == '}';
+        const bool canClose = object ? (state == Expect::KeyOrEnd || state == Expect::CommaOrEnd)
+                                     : (state == Expect::ValueOrEnd || state == Expect::CommaOrEnd);
+        if (depth == 0 || stack[depth - 1].object != object || !canClose) {
+            fail();
+            return;
+        }
+        --depth;
+        endValue();
+        return;
+    }
+
+    case ':':
+        if (state != Expect::Colon) { fail(); return; }
+        state = Expect::Value;
+        return;
+
+    case ',':
+        if (state != Expect::CommaOrEnd) { fail(); return; }
+        state = stack[depth - 1].object ? Expect::Key : Expect::Value;
+        return;
+    }
+    fail();
+}
+
+void StreamParser::string(std::string_view text, bool hasEscapes) {
+    // Object key
+    if (state == Expect::KeyOrEnd || state == Expect::Key) {
+        if (depth == 1) {
+            topKey = hasEscapes || truncated ? TopKey::Other
+                   : text == "base"          ? TopKey::Base
+                   : text == "rates"         ? TopKey::Rates
+                                             : TopKey::Other;
+        } else if (inRates()) {
+            ++entries;
+            // Currency codes never need escapes; anything odd is skipped
+            keyUsable = !hasEscapes && !truncated && !text.empty() && text.size() <= MaxToken;
+            keyLen = keyUsable ? text.size() : 0;
+            std::memcpy(key.data(), text.data(), keyLen);
+        }
+        state = Expect::Colon;
+        return;
+    }
+
+    if (!beginValue()) return;
+    if (depth == 0) {
+        fail();
+        return;
+    }
+    if (depth == 1 && topKey == TopKey::Base) {
+        if (hasEscapes || truncated) {
+            fail();
+            return;
+        }
+        base = QString::fromUtf8(text.data(), static_cast<qsizetype>(text.size()));
+        baseSeen = true;
+        if (!provisionalBase)
+            snapshot.setBase(base);
+    }
+    endValue();
+}
+
+void StreamParser::scalar(std::string_view text, bool isNumber) {
+    if (!beginValue()) return;
+    if (depth == 0 || (!isNumber && text != "true" && text != "false" && text != "null")) {
+        fail();
+        return;
+    }
+    // An over-long number is only checked if it is a rate; then it is skipped
+    if (isNumber && inRates() && keyUsable && !truncated)
+        addRate(std::string_view(key.data(), keyLen), text);
+    endValue();
+}
+
+void StreamParser::addRate(std::string_view code, std::string_view number) {
+    double rate = 0.0;
+    const auto r = std::from_chars(number.data(), number.data() + number.size(), rate);
+    if (r.ec != std::errc() || r.ptr != number.data() + number.size()) {
+        if (r.ec != std::errc::result_out_of_range) fail();
+        return;
+    }
+    if (!(rate > 0.0))
+        return;
+
+    const QString currency = QString::fromUtf8(code.data(), static_cast<qsizetype>(code.size()));
+
+    // Rates ahead of "base": anchor on the default until the base shows up
+    if (!baseSeen && !provisionalBase) {
+        snapshot.setBase("USD");
+        provisionalBase = true;
+    }
+    if (provisionalBase) {
+        if (currency == QString("USD")) provisionalListed = true;
+        snapshot.setBaseRate(currency, rate);
+        return;
+    }
+
+    if (currency != base)
+        snapshot.setBaseRate(currency, rate);
+}
+
+Status StreamParser::finish() {
+    if (invalid || lex != Lex::Between || state != Expect::Done)
+        return Status::Invalid;     // malformed or cut short
+    if (entries == 0)
+        return Status::Empty;
+
+    if (provisionalBase) {
+        const QString provisional("USD");
+        if (baseSeen && base != provisional && !provisionalListed)
+            snapshot.removeCurrency(provisional);
+        snapshot.setBase(baseSeen ? base : provisional);   // pins the base at 1
+    }
+    return Status::Ok;
+}
+
+} // namespace RatesPayload
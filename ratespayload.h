@@ -0,0 +1,99 @@
+#ifndef RATESPAYLOAD_H
+#define RATESPAYLOAD_H
+
+#include <QByteArray>
+#include <QByteArrayView>
+#include <QString>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+#include "ratesnapshot.h"
+
+// Parsing of the rates provider's JSON document:
+//     { "base": "USD", "rates": { "EUR": 0.92, "ZAR": 18.4, ... } }
+namespace RatesPayload {
+
+enum class Status { Ok, Invalid, Empty };
+
+// Fills `snapshot` with one base-relative rate per currency. A missing
+// "base" means USD; non-positive rates are skipped.
+Status parse(const QByteArray &json, RateSnapshot &snapshot);
+
+// parse() on a file's contents; Invalid if it cannot be read
+Status load(const QString &path, RateSnapshot &snapshot);
+
+// Incremental form of parse(): feed() the document in pieces as they
+// arrive and call finish() after the last one. Rates go into the snapshot
+// as soon as their number is complete. Tokens are read in place from each
+// chunk; only a token cut by a chunk boundary is copied, into a small
+// fixed buffer, so memory use does not grow with the payload. Other keys
+// and values of any size or nesting are skipped.
+class StreamParser
+{
+public:
+    StreamParser() = default;
+
+    // Returns false once the document is known to be invalid
+    bool feed(QByteArrayView chunk);
+    Status finish();
+
+    RateSnapshot takeSnapshot() { return std::move(snapshot); }
+
+private:
+    static constexpr std::size_t MaxToken = 64;     // longest key/number kept
+    static constexpr std::size_t MaxDepth = 64;
+
+    enum class Lex : std::uint8_t { Between, String, Number, Literal };
+    enum class Expect : std::uint8_t { Value, ValueOrEnd, KeyOrEnd, Key, Colon, CommaOrEnd, Done };
+    enum class TopKey : std::uint8_t { Other, Base, Rates };
+
+    struct Frame {
+        bool object;
+        bool rates;     // the "rates" object of the top-level document
+    };
+
+    void punct(char c);
+    void string(std::string_view text, bool escaped);
+    void scalar(std::string_view text, bool isNumber);
+    bool beginValue();
+    void endValue();
+    void addRate(std::string_view code, std::string_view number);
+    void fail() { state = Expect::Done; invalid = true; }
+
+    bool inRates() const { return depth == 2 && stack[1].rates; }
+
+    RateSnapshot snapshot;
+    std::size_t entries = 0;    // keys seen in "rates"
+
+    // Lexer
+    Lex lex = Lex::Between;
+    bool escape = false;        // previous string byte was a backslash
+    bool escaped = false;       // current string contains escapes
+    bool spilled = false;       // current token started in an earlier chunk
+    bool truncated = false;     // current token did not fit `carry`
+    std::size_t carryLen = 0;
+    std::array<char, MaxToken> carry{};
+
+    // Grammar
+    Expect state = Expect::Value;
+    std::array<Frame, MaxDepth> stack{};
+    std::size_t depth = 0;
+    bool invalid = false;
+    TopKey topKey = TopKey::Other;
+    std::size_t keyLen = 0;     // pending currency code inside "rates"
+    bool keyUsable = false;
+    std::array<char, MaxToken> key{};
+
+    // Base currency; rates seen before "base" are anchored on USD and
+    // re-anchored in finish()
+    QString base;
+    bool baseSeen = false;
+    bool provisionalBase = false;
+    bool provisionalListed = false;     // USD itself appeared among the rates
+};
+
+} // namespace RatesPayload
+
+#endif // RATESPAYLOAD_H
@@ -0,0 +1,97 @@
+#ifndef REQUESTREADER_H
+#define REQUESTREADER_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <span>
+
+#include "convertprotocol.h"
+
+namespace ConvertProtocol {
+
+// Reassembles request frames from a byte stream that may stop anywhere:
+// the header first, then the payload straight into an aligned buffer that
+// is reused, and grown, from one frame to the next. Qt-free; the daemon
+// feeds it from its socket.
+class RequestReader
+{
+public:
+    enum class Step {
+        NeedMore,   // the source ran dry mid-frame
+        Frame,      // header() and payload() hold a complete request
+        Bad,        // invalid header; the stream cannot be resynchronised,
+                    // so stop reading it
+    };
+
+    // Reads through `read(char *to, std::size_t max)`, which returns the
+    // bytes it copied, 0 when none are available yet. Call again after
+    // NeedMore once more bytes have arrived, and after Frame for the next.
+    template <class Read>
+    Step next(Read &&read);
+
+    const FrameHeader &header() const { return head; }
+
+    // The payload of the last complete frame; writable, so replies can
+    // reuse it in place
+    std::span<char> payload() { return {buffer.get(), head.payloadBytes}; }
+
+    // Op, size and alignment checks a request header must pass
+    static bool isValid(const FrameHeader &h) {
+        const bool convert = h.code == static_cast<std::uint16_t>(Op::Convert);
+        const bool resolve = h.code == static_cast<std::uint16_t>(Op::Resolve);
+        return (convert || resolve) && h.payloadBytes <= MaxPayloadBytes
+            && (!convert || h.payloadBytes % sizeof(double) == 0);
+    }
+
+private:
+    static constexpr std::size_t Alignment = 64;
+
+    struct AlignedDelete {
+        void operator()(char *p) const { ::operator delete[](p, std::align_val_t(Alignment)); }
+    };
+
+    FrameHeader head{};
+    std::size_t headerHave = 0;
+    std::size_t payloadHave = 0;
+    bool complete = false;
+    std::unique_ptr<char[], AlignedDelete> buffer;
+    std::size_t capacity = 0;
+};
+
+template <class Read>
+RequestReader::Step RequestReader::next(Read &&read)
+{
+    if (complete) {
+        headerHave = 0;
+        complete = false;
+    }
+
+    if (headerHave < sizeof(FrameHeader)) {
+        headerHave += read(reinterpret_cast<char *>(&head) + headerHave, sizeof(FrameHeader) - headerHave);
+        if (headerHave < sizeof(FrameHeader)) return Step::NeedMore;
+        if (!isValid(head)) return Step::Bad;
+
+        if (head.payloadBytes > capacity) {
+            const std::size_t size = std::max<std::size_t>(head.payloadBytes, capacity * 2);
+            buffer.reset(static_cast<char *>(::operator new[](size, std::align_val_t(Alignment))));
+            capacity = size;
+        }
+        payloadHave = 0;
+    }
+
+    while (payloadHave < head.payloadBytes) {
+        const std::size_t n = read(buffer.get() + payloadHave, head.payloadBytes - payloadHave);
+        if (n == 0) return Step::NeedMore;
+        payloadHave += n;
+    }
+
+    complete = true;
+    return Step::Frame;
+}
+
+} // namespace ConvertProtocol
+
+#endif // REQUESTREADER_H
@@ -0,0 +1,30 @@
+#ifndef TESTS_CHECK_H
+#define TESTS_CHECK_H
+
+#include <cstdio>
+
+// Assertions for the test executables. A failed CHECK reports where it
+// failed and the test carries on; main returns Check::result(), which is
+// non-zero if anything failed, for CTest.
+namespace Check {
+
+inline int &failures() {
+    static int count = 0;
+    return count;
+}
+
+inline void fail(const char *file, int line, const char *what) {
+    std::fprintf(stderr, "%s:%d: CHECK(%s) failed\n", file, line, what);
+    ++failures();
+}
+
+inline int result() {
+    if (failures() > 0) std::fprintf(stderr, "%d check(s) failed\n", failures());
+    return failures() > 0 ? 1 : 0;
+}
+
+} // namespace Check
+
+#define CHECK(condition) ((condition) ? (void)0 : Check::fail(__FILE__, __LINE__, #condition))
+
+#endif // TESTS_CHECK_H
@@ -0,0 +1,201 @@
+// convertd framing: FrameHeader layout, RequestReader on frames split
+// anywhere, and the headers it must refuse.
+
+#include "check.h"
+#include "requestreader.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace ConvertProtocol;
+
+namespace {
+
+using Step = RequestReader::Step;
+
+// Hands out a byte string, at most `limit` bytes per call
+struct Source {
+    std::string bytes;
+    std::size_t at = 0;
+    std::size_t end = 0;        // bytes "arrived" so far
+    std::size_t limit = ~std::size_t(0);
+
+    std::size_t operator()(char *to, std::size_t max) {
+        const std::size_t n = std::min({max, end - at, limit});
+        std::memcpy(to, bytes.data() + at, n);
+        at += n;
+        return n;
+    }
+};
+
+std::string frame(Op op, std::uint16_t from, std::uint16_t to, std::uint32_t tag, const std::string &payload)
+{
+    FrameHeader h{};
+    h.payloadBytes = static_cast<std::uint32_t>(payload.size());
+    h.tag = tag;
+    h.from = from;
+    h.to = to;
+    h.code = static_cast<std::uint16_t>(op);
+    return std::string(reinterpret_cast<const char *>(&h), sizeof(h)) + payload;
+}
+
+std::string doubles(std::initializer_list<double> values)
+{
+    std::string out(values.size() * sizeof(double), '\0');
+    std::memcpy(out.data(), std::data(values), out.size());
+    return out;
+}
+
+struct Got {
+    FrameHeader header;
+    std::string payload;
+};
+
+// Runs the reader until the source is dry, collecting complete frames
+Step drain(RequestReader &reader, Source &source, std::vector<Got> &got)
+{
+    for (;;) {
+        const Step step = reader.next(source);
+        if (step != Step::Frame) return step;
+        const std::span<char> p = reader.payload();
+        got.push_back({reader.header(), std::string(p.data(), p.size())});
+    }
+}
+
+void testHeaderLayout()
+{
+    // Both ends copy the struct as is, so the wire layout is the struct's
+    FrameHeader h{};
+    h.payloadBytes = 0x04030201;
+    h.tag = 0x08070605;
+    h.from = 0x0A09;
+    h.to = 0x0C0B;
+    h.code = 0x0E0D;
+    h.reserved = 0x100F;
+    unsigned char raw[sizeof(FrameHeader)];
+    std::memcpy(raw, &h, sizeof(h));
+
+    FrameHeader back;
+    std::memcpy(&back, raw, sizeof(back));
+    CHECK(back.payloadBytes == h.payloadBytes && back.tag == h.tag && back.from == h.from
+          && back.to == h.to && back.code == h.code && back.reserved == h.reserved);
+    CHECK(offsetof(FrameHeader, tag) == 4 && offsetof(FrameHeader, from) == 8
+          && offsetof(FrameHeader, code) == 12);
+}
+
+void testRoundTrip()
+{
+    Source source;
+    source.bytes = frame(Op::Convert, 3, 7, 42, doubles({1.5, -2.0, 1e300}))
+                 + frame(Op::Resolve, 0, 0, 43, "km")
+                 + frame(Op::Convert, 1, 2, 44, "");
+    source.end = source.bytes.size();
+
+    RequestReader reader;
+    std::vector<Got> got;
+    CHECK(drain(reader, source, got) == Step::NeedMore);
+    CHECK(got.size() == 3);
+    if (got.size() != 3) return;
+
+    CHECK(got[0].header.tag == 42 && got[0].header.from == 3 && got[0].header.to == 7);
+    CHECK(got[0].header.code == static_cast<std::uint16_t>(Op::Convert));
+    CHECK(got[0].payload == doubles({1.5, -2.0, 1e300}));
+    CHECK(got[1].header.tag == 43 && got[1].payload == "km");
+    CHECK(got[2].header.tag == 44 && got[2].payload.empty());
+}
+
+// Frames cut at every byte, and trickled in a byte per read, come out
+// whole and identical; nothing completes early
+void testTruncated()
+{
+    const std::string stream = frame(Op::Convert, 1, 2, 7, doubles({1.0, 2.0, 3.0}))
+                             + frame(Op::Resolve, 0, 0, 8, "metre");
+    const std::size_t firstEnd = sizeof(FrameHeader) + 3 * sizeof(double);
+
+    for (std::size_t cut = 0; cut <= stream.size(); ++cut) {
+        Source source;
+        source.bytes = stream;
+        source.end = cut;
+        RequestReader reader;
+        std::vector<Got> got;
+        CHECK(drain(reader, source, got) == Step::NeedMore);
+        CHECK(got.size() == (cut >= stream.size() ? 2u : cut >= firstEnd ? 1u : 0u));
+
+        source.end = stream.size();
+        CHECK(drain(reader, source, got) == Step::NeedMore);
+        CHECK(got.size() == 2);
+        if (got.size() == 2) {
+            CHECK(got[0].header.tag == 7 && got[0].payload == doubles({1.0, 2.0, 3.0}));
+            CHECK(got[1].header.tag == 8 && got[1].payload == "metre");
+        }
+    }
+
+    Source slow;
+    slow.bytes = stream;
+    slow.limit = 1;
+    RequestReader reader;
+    std::vector<Got> got;
+    for (std::size_t i = 1; i <= stream.size(); ++i) {
+        slow.end = i;
+        CHECK(drain(reader, slow, got) == Step::NeedMore);
+    }
+    CHECK(got.size() == 2);
+}
+
+// A later, larger frame grows the buffer; a smaller one reuses it
+void testBufferReuse()
+{
+    Source source;
+    source.bytes = frame(Op::Convert, 1, 2, 1, doubles({1.0}))
+                 + frame(Op::Convert, 1, 2, 2, std::string(4096 * sizeof(double), 'x'))
+                 + frame(Op::Convert, 1, 2, 3, doubles({4.0, 5.0}));
+    source.end = source.bytes.size();
+    RequestReader reader;
+    std::vector<Got> got;
+    drain(reader, source, got);
+    CHECK(got.size() == 3);
+    if (got.size() == 3) {
+        CHECK(got[1].payload.size() == 4096 * sizeof(double));
+        CHECK(got[2].payload == doubles({4.0, 5.0}));
+    }
+}
+
+void testBadHeaders()
+{
+    FrameHeader h{};
+    h.code = 9;
+    CHECK(!RequestReader::isValid(h));                              // unknown op
+    h.code = static_cast<std::uint16_t>(Op::Convert);
+    h.payloadBytes = 12;
+    CHECK(!RequestReader::isValid(h));                              // not whole doubles
+    h.payloadBytes = MaxPayloadBytes + 8;
+    CHECK(!RequestReader::isValid(h));                              // too large
+    h.payloadBytes = MaxPayloadBytes;
+    CHECK(RequestReader::isValid(h));
+    h.code = static_cast<std::uint16_t>(Op::Resolve);
+    h.payloadBytes = 3;
+    CHECK(RequestReader::isValid(h));                               // names may be any length
+
+    // Refused once the header is complete, before any payload is read
+    Source source;
+    source.bytes = frame(Op::Convert, 1, 2, 1, "abc");
+    source.end = source.bytes.size();
+    RequestReader reader;
+    CHECK(reader.next(source) == Step::Bad);
+    CHECK(source.at == sizeof(FrameHeader));
+}
+
+} // namespace
+
+int main()
+{
+    testHeaderLayout();
+    testRoundTrip();
+    testTruncated();
+    testBufferReuse();
+    testBadHeaders();
+    return Check::result();
+}
@@ -0,0 +1,205 @@
+// HttpParser::parseRequest on split, pipelined and malformed input.
+
+#include "check.h"
+#include "httpparser.h"
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace HttpParser;
+
+namespace {
+
+constexpr Limits TestLimits{1024, 4096};
+
+struct Parsed {
+    ParseResult result;
+    Request req;
+    std::size_t consumed = 0;
+    int status = 0;
+    bool expectContinue = false;
+};
+
+Parsed parse(std::string_view buffer, const Limits &limits = TestLimits)
+{
+    Parsed p;
+    p.result = parseRequest(buffer, limits, p.req, p.consumed, p.status, p.expectContinue);
+    return p;
+}
+
+struct Seen {
+    std::string method, target, body;
+    bool keepAlive;
+};
+
+// Parses every complete request off the front of `buffer`, as
+// ServerWorker does, and drops them from it
+void drain(std::string &buffer, std::vector<Seen> &seen)
+{
+    for (;;) {
+        const Parsed p = parse(buffer);
+        if (p.result != ParseResult::Complete) {
+            CHECK(p.result == ParseResult::Incomplete);
+            return;
+        }
+        seen.push_back({std::string(p.req.method), std::string(p.req.target), std::string(p.req.body),
+                        p.req.keepAlive});
+        buffer.erase(0, p.consumed);
+    }
+}
+
+const std::string Get = "GET /convert?from=Miles&to=Feet&value=3 HTTP/1.1\r\nHost: x\r\n\r\n";
+const std::string Post = "POST /convert HTTP/1.1\r\nHost: x\r\nContent-Length: 13\r\n\r\n"
+                         "{\"value\": 42}";
+const std::string Close = "GET /convert HTTP/1.1\r\nConnection: close\r\n\r\n";
+
+void testSingleRequest()
+{
+    const Parsed p = parse(Post);
+    CHECK(p.result == ParseResult::Complete);
+    CHECK(p.consumed == Post.size());
+    CHECK(p.req.method == "POST");
+    CHECK(p.req.target == "/convert");
+    CHECK(p.req.body == "{\"value\": 42}");
+    CHECK(p.req.keepAlive);
+    CHECK(!p.expectContinue);
+}
+
+// Every proper prefix is Incomplete, and the whole request parses the same
+// whichever byte the last read ended on
+void testSplitAtEveryByte()
+{
+    for (const std::string &request : {Get, Post, Close}) {
+        for (std::size_t cut = 0; cut < request.size(); ++cut)
+            CHECK(parse(std::string_view(request).substr(0, cut)).result == ParseResult::Incomplete);
+    }
+
+    const std::string stream = Get + Post + "\r\n" + Close;
+    for (std::size_t cut = 0; cut <= stream.size(); ++cut) {
+        std::string buffer = stream.substr(0, cut);
+        std::vector<Seen> seen;
+        drain(buffer, seen);
+        buffer += stream.substr(cut);
+        drain(buffer, seen);
+
+        CHECK(buffer.empty());
+        CHECK(seen.size() == 3);
+        if (seen.size() != 3) continue;
+        CHECK(seen[0].method == "GET" && seen[0].target == "/convert?from=Miles&to=Feet&value=3");
+        CHECK(seen[1].method == "POST" && seen[1].body == "{\"value\": 42}");
+        CHECK(seen[2].target == "/convert" && !seen[2].keepAlive);
+    }
+}
+
+// One byte at a time, as a slow client would send it
+void testByteAtATime()
+{
+    const std::string stream = Post + Get + Post;
+    std::string buffer;
+    std::vector<Seen> seen;
+    for (char c : stream) {
+        buffer += c;
+        drain(buffer, seen);
+    }
+    CHECK(buffer.empty());
+    CHECK(seen.size() == 3);
+    if (seen.size() == 3) {
+        CHECK(seen[0].body == "{\"value\": 42}");
+        CHECK(seen[1].method == "GET" && seen[1].body.empty());
+        CHECK(seen[2].body == "{\"value\": 42}");
+    }
+}
+
+void testPipelined()
+{
+    const std::string stream = Get + "\r\n\r\n" + Post + Get;
+    std::size_t offset = 0;
+    std::vector<std::string> methods;
+    for (;;) {
+        const Parsed p = parse(std::string_view(stream).substr(offset));
+        if (p.result != ParseResult::Complete) {
+            CHECK(p.result == ParseResult::Incomplete);
+            break;
+        }
+        methods.emplace_back(p.req.method);
+        offset += p.consumed;
+    }
+    CHECK(offset == stream.size());
+    CHECK((methods == std::vector<std::string>{"GET", "POST", "GET"}));
+}
+
+void testContentLength()
+{
+    // The body ends where Content-Length says, not at the end of the buffer
+    Parsed p = parse("POST /convert HTTP/1.1\r\ncontent-length: 2\r\n\r\n{}GET");
+    CHECK(p.result == ParseResult::Complete);
+    CHECK(p.req.body == "{}");
+    CHECK(p.consumed == std::string_view("POST /convert HTTP/1.1\r\ncontent-length: 2\r\n\r\n{}").size());
+
+    p = parse("POST /convert HTTP/1.1\r\nContent-Length:  0 \r\n\r\n");
+    CHECK(p.result == ParseResult::Complete && p.req.body.empty());
+
+    for (const char *bad : {"12x", "-1", "", "0x10", "99999999999999999999999"}) {
+        p = parse(std::string("POST / HTTP/1.1\r\nContent-Length: ") + bad + "\r\n\r\n");
+        CHECK(p.result == ParseResult::Error && p.status == 400);
+    }
+
+    p = parse("POST / HTTP/1.1\r\nContent-Length: 4097\r\n\r\n");
+    CHECK(p.result == ParseResult::Error && p.status == 413);
+
+    // Answered with 100 Continue while the body is outstanding
+    p = parse("POST / HTTP/1.1\r\nExpect: 100-continue\r\nContent-Length: 5\r\n\r\nab");
+    CHECK(p.result == ParseResult::Incomplete && p.expectContinue);
+}
+
+void testTransferEncodingRejected()
+{
+    for (const char *header : {"Transfer-Encoding: chunked", "transfer-encoding: gzip, chunked",
+                               "TRANSFER-ENCODING: identity"}) {
+        const Parsed p = parse(std::string("POST / HTTP/1.1\r\n") + header + "\r\n\r\n5\r\nhello\r\n0\r\n\r\n");
+        CHECK(p.result == ParseResult::Error && p.status == 501);
+    }
+}
+
+void testConnectionHandling()
+{
+    CHECK(!parse("GET / HTTP/1.0\r\n\r\n").req.keepAlive);
+    CHECK(parse("GET / HTTP/1.0\r\nConnection: Keep-Alive\r\n\r\n").req.keepAlive);
+    CHECK(!parse("GET / HTTP/1.1\r\nConnection: upgrade, close\r\n\r\n").req.keepAlive);
+    CHECK(parse("GET / HTTP/1.1\r\nConnection: closed\r\n\r\n").req.keepAlive);
+}
+
+void testMalformed()
+{
+    Parsed p = parse("GET / HTTP/2.0\r\n\r\n");
+    CHECK(p.result == ParseResult::Error && p.status == 505);
+    p = parse("GET / SPDY/3\r\n\r\n");
+    CHECK(p.result == ParseResult::Error && p.status == 400);
+    p = parse("GET\r\n\r\n");
+    CHECK(p.result == ParseResult::Error && p.status == 400);
+    p = parse("GET / HTTP/1.1\r\nno colon here\r\n\r\n");
+    CHECK(p.result == ParseResult::Error && p.status == 400);
+
+    // Oversized headers are refused before they are complete
+    const std::string big = "GET / HTTP/1.1\r\nX-Pad: " + std::string(TestLimits.maxHeaderBytes, 'a');
+    p = parse(big);
+    CHECK(p.result == ParseResult::Error && p.status == 431);
+    p = parse(big + "\r\n\r\n");
+    CHECK(p.result == ParseResult::Error && p.status == 431);
+}
+
+} // namespace
+
+int main()
+{
+    testSingleRequest();
+    testSplitAtEveryByte();
+    testByteAtATime();
+    testPipelined();
+    testContentLength();
+    testTransferEncodingRejected();
+    testConnectionHandling();
+    testMalformed();
+    return Check::result();
+}
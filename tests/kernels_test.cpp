@@ -0,0 +1,142 @@
+// Every SIMD kernel this CPU can run, at every tail length and alignment,
+// must match ConversionPlan::apply(double) element for element.
+
+#include "check.h"
+#include "conversionkernels.h"
+#include "conversionplan.h"
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <limits>
+#include <span>
+#include <vector>
+
+using namespace ConversionKernels;
+
+namespace {
+
+constexpr Isa AllIsas[] = {Isa::Scalar, Isa::SSE2, Isa::AVX2, Isa::AVX512};
+
+// Past two full iterations of the widest (16-double) loop and every tail
+constexpr std::size_t MaxCount = 70;
+constexpr std::size_t MaxMisalign = 3;      // doubles off the vector's start
+constexpr double Guard = 12345.678;
+
+// Bit-identical, with any two NaNs counted as equal
+bool same(double a, double b)
+{
+    if (std::isnan(a) && std::isnan(b)) return true;
+    return std::memcmp(&a, &b, sizeof(double)) == 0;
+}
+
+std::vector<double> inputs()
+{
+    using L = std::numeric_limits<double>;
+    std::vector<double> v = {
+        0.0, -0.0, 1.0, -1.0, L::infinity(), -L::infinity(), L::quiet_NaN(),
+        L::denorm_min(), -L::denorm_min(), L::min(), L::max(), -L::max(), L::epsilon(),
+    };
+    // Deterministic filler spread over many magnitudes
+    std::uint64_t x = 0x9E3779B97F4A7C15u;
+    while (v.size() < MaxCount + MaxMisalign) {
+        x ^= x << 13;
+        x ^= x >> 7;
+        x ^= x << 17;
+        const double mantissa = static_cast<double>(x >> 11) / static_cast<double>(1ull << 53);
+        const int exponent = static_cast<int>(x % 41) - 20;
+        v.push_back((x & 1 ? -1.0 : 1.0) * std::ldexp(mantissa, exponent));
+    }
+    return v;
+}
+
+// Pure scales use the scale kernel, the rest the affine one
+const ConversionPlan Plans[] = {
+    ConversionPlan::affine(0.3048),
+    ConversionPlan::affine(1.0 / 3.0),
+    ConversionPlan::affine(-2.5),
+    ConversionPlan::affine(1e-300),                     // results go subnormal
+    ConversionPlan::affine(1.8, 32.0),
+    ConversionPlan::affine(1.0, -273.15),
+    ConversionPlan::affine(5.0 / 9.0, -160.0 / 9.0),
+    ConversionPlan::affine(1e308, 1e308),               // overflows to inf
+};
+
+void run(Isa isa, const ConversionPlan &plan, const double *in, double *out, std::size_t count)
+{
+    if (plan.offset() == 0.0)
+        scale(isa, in, out, count, plan.scale());
+    else
+        affine(isa, in, out, count, plan.scale(), plan.offset());
+}
+
+void testEveryKernel()
+{
+    const std::vector<double> values = inputs();
+    for (Isa isa : AllIsas) {
+        if (!isSupported(isa)) continue;
+        for (const ConversionPlan &plan : Plans) {
+            for (std::size_t misalign = 0; misalign <= MaxMisalign; ++misalign) {
+                for (std::size_t count = 0; count <= MaxCount; ++count) {
+                    const double *in = values.data() + misalign;
+
+                    // Out of place, into a buffer with a guard on either side
+                    std::vector<double> out(count + 2 * (MaxMisalign + 1), Guard);
+                    double *dst = out.data() + misalign + 1;
+                    run(isa, plan, in, dst, count);
+                    bool ok = true;
+                    for (std::size_t i = 0; i < count; ++i)
+                        ok = ok && same(dst[i], plan.apply(in[i]));
+                    for (double *g = out.data(); g < dst; ++g) ok = ok && *g == Guard;
+                    for (double *g = dst + count; g < out.data() + out.size(); ++g) ok = ok && *g == Guard;
+                    CHECK(ok);
+
+                    // In place
+                    std::vector<double> inout(in, in + count);
+                    run(isa, plan, inout.data(), inout.data(), count);
+                    ok = true;
+                    for (std::size_t i = 0; i < count; ++i)
+                        ok = ok && same(inout[i], plan.apply(in[i]));
+                    CHECK(ok);
+                }
+            }
+        }
+    }
+}
+
+// The span overload, on whatever kernel activeIsa() picked, including the
+// pass-through paths for identity and invalid plans
+void testPlanApply()
+{
+    const std::vector<double> values = inputs();
+    std::vector<ConversionPlan> plans(std::begin(Plans), std::end(Plans));
+    plans.push_back(ConversionPlan::affine(1.0));
+    plans.push_back(ConversionPlan::invalid());
+
+    for (const ConversionPlan &plan : plans) {
+        for (std::size_t count = 0; count <= MaxCount; ++count) {
+            std::vector<double> out(count + 1, Guard);
+            plan.apply(std::span<const double>(values.data(), count), std::span<double>(out.data(), count));
+            bool ok = out[count] == Guard;
+            for (std::size_t i = 0; i < count; ++i)
+                ok = ok && same(out[i], plan.isValid() ? plan.apply(values[i]) : values[i]);
+            CHECK(ok);
+
+            // Shorter output: only min(in, out) values are written
+            std::vector<double> shorter(count / 2 + 1, Guard);
+            plan.apply(std::span<const double>(values.data(), count),
+                       std::span<double>(shorter.data(), count / 2));
+            CHECK(shorter.back() == Guard);
+        }
+    }
+}
+
+} // namespace
+
+int main()
+{
+    testEveryKernel();
+    testPlanApply();
+    return Check::result();
+}
@@ -0,0 +1,90 @@
+// Units rate snapshots: readers racing a writer never see a freed or
+// half-built snapshot, and replaced snapshots are freed once unread.
+// Run under AddressSanitizer to catch use after free.
+
+#include "check.h"
+#include "units.h"
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// Version v has EUR as base, USD at v and GBP at 2v, so any consistent
+// snapshot prices GBP at exactly 2 USD
+RateSnapshot ratesFor(std::uint64_t v)
+{
+    RateSnapshot rates;
+    rates.setBase(QString("EUR"));
+    rates.setBaseRate(QString("USD"), static_cast<double>(v));
+    rates.setBaseRate(QString("GBP"), 2.0 * static_cast<double>(v));
+    return rates;
+}
+
+void testReplacedSnapshotsAreFreed()
+{
+    Units &units = Units::getInstance();
+    units.publishRates(ratesFor(1));
+
+    std::weak_ptr<const RateSnapshot> old = units.rateSnapshot();
+    RateSnapshotPtr kept = units.rateSnapshot();
+    units.publishRates(ratesFor(2));
+
+    // A reader that took a reference keeps its version
+    CHECK(!old.expired());
+    double rate = 0;
+    CHECK(kept->rate(QString("EUR"), QString("USD"), rate) && rate == 1.0);
+    CHECK(units.getCurrencyRate(QString("EUR"), QString("USD"), rate) && rate == 2.0);
+
+    kept.reset();
+    CHECK(old.expired());
+}
+
+void testReadersRacingWriter()
+{
+    Units &units = Units::getInstance();
+    constexpr int Readers = 4;
+    constexpr std::uint64_t Versions = 2000;
+
+    std::atomic<bool> done{false};
+    std::atomic<int> bad{0};
+    std::vector<std::thread> readers;
+    for (int t = 0; t < Readers; ++t) {
+        readers.emplace_back([&] {
+            while (!done.load(std::memory_order_relaxed)) {
+                const RateSnapshotPtr s = units.rateSnapshot();
+                double rate = 0;
+                if (!s->rate(QString("USD"), QString("GBP"), rate) || rate != 2.0) ++bad;
+                if (!units.getCurrencyRate(QString("USD"), QString("GBP"), rate) || rate != 2.0) ++bad;
+            }
+        });
+    }
+
+    std::vector<std::weak_ptr<const RateSnapshot>> published;
+    for (std::uint64_t v = 1; v <= Versions; ++v) {
+        units.publishRates(ratesFor(v));
+        published.push_back(units.rateSnapshot());
+    }
+    done = true;
+    for (std::thread &t : readers) t.join();
+    CHECK(bad == 0);
+
+    // With every hazard dropped, the next read frees whatever the last
+    // publishes had to keep; only the current snapshot is left
+    units.rateSnapshot();
+    std::size_t alive = 0;
+    for (const auto &p : published) alive += !p.expired();
+    CHECK(alive == 1);
+    CHECK(!published.back().expired());
+}
+
+} // namespace
+
+int main()
+{
+    testReplacedSnapshotsAreFreed();
+    testReadersRacingWriter();
+    return Check::result();
+}
@@ -0,0 +1,158 @@
+// RatesPayload::StreamParser fed in every possible way must agree with
+// parsing the whole document at once.
+
+#include "check.h"
+#include "ratespayload.h"
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+using RatesPayload::Status;
+using RatesPayload::StreamParser;
+
+namespace {
+
+struct Result {
+    Status status;
+    RateSnapshot snapshot;
+};
+
+Result parseWhole(const std::string &json)
+{
+    Result r;
+    r.status = RatesPayload::parse(QByteArray(json.data(), static_cast<qsizetype>(json.size())), r.snapshot);
+    return r;
+}
+
+// Feeds `json` cut at the given offsets
+Result parseChunked(const std::string &json, const std::vector<std::size_t> &cuts)
+{
+    StreamParser parser;
+    std::size_t from = 0;
+    for (std::size_t cut : cuts) {
+        parser.feed(QByteArrayView(json.data() + from, static_cast<qsizetype>(cut - from)));
+        from = cut;
+    }
+    parser.feed(QByteArrayView(json.data() + from, static_cast<qsizetype>(json.size() - from)));
+
+    Result r;
+    r.status = parser.finish();
+    if (r.status == Status::Ok) r.snapshot = parser.takeSnapshot();
+    return r;
+}
+
+// Same status, base and currencies, with bit-identical rates
+bool same(const Result &a, const Result &b)
+{
+    if (a.status != b.status || a.snapshot.base() != b.snapshot.base() || a.snapshot.size() != b.snapshot.size())
+        return false;
+    for (std::uint32_t i = 0; i < a.snapshot.size(); ++i) {
+        const std::uint32_t j = b.snapshot.currencyIndex(a.snapshot.currencyCode(i));
+        if (j >= b.snapshot.size()) return false;
+        const double x = a.snapshot.baseRate(i), y = b.snapshot.baseRate(j);
+        if (std::memcmp(&x, &y, sizeof(double)) != 0) return false;
+    }
+    return true;
+}
+
+double rateOf(const RateSnapshot &snapshot, const char *code)
+{
+    const std::uint32_t i = snapshot.currencyIndex(QString(code));
+    return i < snapshot.size() ? snapshot.baseRate(i) : -1.0;
+}
+
+const std::string Documents[] = {
+    R"({"base":"EUR","rates":{"USD":1.08,"ZAR":20.125,"JPY":161.5}})",
+    // Rates before "base", whitespace everywhere, other keys of any shape
+    "{ \"rates\" : { \"EUR\" : 0.92 ,\n\t\"GBP\":7.9e-1 } , \"base\" : \"USD\",\n"
+    " \"meta\": {\"list\": [1, [2, {\"x\": null}], true, false], \"s\": \"a\\\"b\\\\\"} }",
+    // No base at all: USD is assumed
+    R"({"rates":{"EUR":0.9,"CHF":0.88},"timestamp":1700000000})",
+    // Escaped and over-long keys are skipped; so are non-positive rates and
+    // a number too long to keep
+    R"({"base":"USD","rates":{"EUR":1.0,"XXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXX":2.0,)"
+    R"("NEG":-1.5,"ZERO":0,"LONG":1.00000000000000000000000000000000000000000000000000000000000000001,)"
+    R"("SEK":11.25}})",
+    // Empty rates object
+    R"({"base":"USD","rates":{}})",
+    // Invalid: cut short, trailing garbage, bad punctuation, not an object
+    R"({"base":"USD","rates":{"EUR":0.9)",
+    R"({"base":"USD","rates":{"EUR":0.9}} x)",
+    R"({"base":"USD","rates":{"EUR":0.9,}})",
+    R"({"base":"USD" "rates":{}})",
+    R"(["USD"])",
+    R"({"base":"USD","rates":{"EUR":0.9e}})",
+};
+
+void testKnownValues()
+{
+    Result r = parseWhole(Documents[0]);
+    CHECK(r.status == Status::Ok);
+    CHECK(r.snapshot.base() == QString("EUR"));
+    CHECK(rateOf(r.snapshot, "ZAR") == 20.125);
+    CHECK(rateOf(r.snapshot, "EUR") == 1.0);
+
+    r = parseWhole(Documents[1]);
+    CHECK(r.status == Status::Ok && r.snapshot.base() == QString("USD"));
+    CHECK(rateOf(r.snapshot, "GBP") == 0.79 && rateOf(r.snapshot, "EUR") == 0.92);
+
+    r = parseWhole(Documents[2]);
+    CHECK(r.status == Status::Ok && r.snapshot.base() == QString("USD"));
+
+    r = parseWhole(Documents[3]);
+    CHECK(r.status == Status::Ok);
+    CHECK(rateOf(r.snapshot, "SEK") == 11.25);
+    CHECK(rateOf(r.snapshot, "NEG") < 0 && rateOf(r.snapshot, "ZERO") < 0 && rateOf(r.snapshot, "LONG") < 0);
+    CHECK(r.snapshot.size() == 3);      // USD, EUR, SEK
+
+    CHECK(parseWhole(Documents[4]).status == Status::Empty);
+    for (std::size_t i = 5; i < std::size(Documents); ++i)
+        CHECK(parseWhole(Documents[i]).status == Status::Invalid);
+}
+
+void testOneByteAtATime()
+{
+    for (const std::string &json : Documents) {
+        std::vector<std::size_t> cuts;
+        for (std::size_t i = 1; i < json.size(); ++i) cuts.push_back(i);
+        CHECK(same(parseChunked(json, cuts), parseWhole(json)));
+    }
+}
+
+// Every single split point, and every pair of them on the shorter documents
+void testEverySplit()
+{
+    for (const std::string &json : Documents) {
+        const Result whole = parseWhole(json);
+        for (std::size_t a = 0; a <= json.size(); ++a) {
+            CHECK(same(parseChunked(json, {a}), whole));
+            if (json.size() > 120) continue;
+            for (std::size_t b = a; b <= json.size(); ++b)
+                CHECK(same(parseChunked(json, {a, b}), whole));
+        }
+    }
+}
+
+// A number longer than the carry buffer is skipped wherever the chunks
+// split it, never read as its first 64 bytes
+void testLongTokenAcrossChunks()
+{
+    const std::string json = R"({"base":"USD","rates":{"AAA":1.)" + std::string(100, '5') + R"(,"BBB":2}})";
+    for (std::size_t cut = 0; cut <= json.size(); ++cut) {
+        const Result r = parseChunked(json, {cut});
+        CHECK(r.status == Status::Ok);
+        CHECK(rateOf(r.snapshot, "AAA") < 0 && rateOf(r.snapshot, "BBB") == 2.0);
+    }
+}
+
+} // namespace
+
+int main()
+{
+    testKnownValues();
+    testOneByteAtATime();
+    testEverySplit();
+    testLongTokenAcrossChunks();
+    return Check::result();
+}
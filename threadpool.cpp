@@ -0,0 +1,142 @@
+#include "threadpool.h"
+
+#include <algorithm>
+
+/* ===================== LIFETIME ===================== */
+
+WorkStealingPool::WorkStealingPool(unsigned threadCount) {
+    if (threadCount == 0)
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+
+    const unsigned workerCount = threadCount - 1;
+    for (unsigned i = 0; i <= workerCount; ++i)
+        queues.push_back(std::make_unique<Queue>());
+
+    workers.reserve(workerCount);
+    for (unsigned i = 0; i < workerCount; ++i)
+        workers.emplace_back(&WorkStealingPool::workerLoop, this, i);
+}
+
+WorkStealingPool::~WorkStealingPool() {
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        stopping = true;
+    }
+    wake.notify_all();
+
+    for (std::thread &worker : workers)
+        worker.join();
+}
+
+WorkStealingPool &WorkStealingPool::global() {
+    static WorkStealingPool pool;
+    return pool;
+}
+
+/* ===================== SCHEDULING ===================== */
+
+bool WorkStealingPool::takeTask(unsigned self, Task &task) {
+    // Own queue first, newest chunk (still warm in cache)
+    {
+        Queue &own = *queues[self];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty()) {
+            task = own.tasks.back();
+            own.tasks.pop_back();
+            queuedTasks.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+
+    // Then steal the oldest chunk from someone else
+    const std::size_t n = queues.size();
+    for (std::size_t k = 1; k < n; ++k) {
+        Queue &victim = *queues[(self + k) % n];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            task = victim.tasks.front();
+            victim.tasks.pop_front();
+            queuedTasks.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    return false;
+}
+
+void WorkStealingPool::runTask(const Task &task) {
+    Job *job = task.job;
+    (*job->fn)(task.begin, task.end);
+
+    // Decrement under the lock so the owner cannot tear the job down
+    // between our decrement and our notify
+    std::lock_guard<std::mutex> lock(job->doneMutex);
+    if (job->remaining.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        job->done.notify_all();
+}
+
+void WorkStealingPool::workerLoop(unsigned self) {
+    for (;;) {
+        Task task;
+        if (takeTask(self, task)) {
+            runTask(task);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        wake.wait(lock, [this]() {
+            return stopping || queuedTasks.load(std::memory_order_relaxed) > 0;
+        });
+        if (stopping && queuedTasks.load(std::memory_order_relaxed) == 0)
+            return;
+    }
+}
+
+/* ===================== PARALLEL FOR ===================== */
+
+void WorkStealingPool::parallelFor(std::size_t count, std::size_t chunkSize, const RangeFn &fn) {
+    if (count == 0) return;
+    chunkSize = std::max<std::size_t>(1, chunkSize);
+
+    const std::size_t chunks = (count + chunkSize - 1) / chunkSize;
+    if (chunks == 1 || workers.empty()) {
+        for (std::size_t begin = 0; begin < count; begin += chunkSize)
+            fn(begin, std::min(count, begin + chunkSize));
+        return;
+    }
+
+    Job job;
+    job.fn = &fn;
+    job.remaining.store(chunks, std::memory_order_relaxed);
+
+    // Deal out contiguous runs of chunks so each thread streams forward
+    const std::size_t queueCount = queues.size();
+    const std::size_t perQueue = (chunks + queueCount - 1) / queueCount;
+    for (std::size_t q = 0; q < queueCount; ++q) {
+        const std::size_t first = q * perQueue;
+        const std::size_t last = std::min(chunks, first + perQueue);
+        if (first >= last) break;
+
+        Queue &queue = *queues[q];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        // Stored reversed: the owner pops from the back, thieves take the tail end
+        for (std::size_t c = last; c-- > first;) {
+            const std::size_t begin = c * chunkSize;
+            queue.tasks.push_back({&job, begin, std::min(count, begin + chunkSize)});
+        }
+        queuedTasks.fetch_add(last - first, std::memory_order_relaxed);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+    }
+    wake.notify_all();
+
+    // The caller works too, then waits for chunks other threads still hold
+    const unsigned self = static_cast<unsigned>(queueCount - 1);
+    Task task;
+    while (job.remaining.load(std::memory_order_acquire) > 0 && takeTask(self, task))
+        runTask(task);
+
+    std::unique_lock<std::mutex> lock(job.doneMutex);
+    job.done.wait(lock, [&job]() { return job.remaining.load(std::memory_order_acquire) == 0; });
+}
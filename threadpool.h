@@ -0,0 +1,77 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Reusable work-stealing pool for data-parallel loops.
+//
+// parallelFor splits [0, count) into fixed-size chunks and deals them out
+// to per-thread queues. Each thread drains its own queue from the back and
+// steals from the front of the others when it runs dry. The calling thread
+// takes part too, so a pool of N threads runs N-1 workers. Threads persist
+// across calls; small loops never pay thread start-up.
+//
+// Chunk boundaries depend only on count and chunkSize, so any per-element
+// work gives the same output no matter which thread runs which chunk.
+class WorkStealingPool
+{
+public:
+    using RangeFn = std::function<void(std::size_t begin, std::size_t end)>;
+
+    // threadCount == 0 uses std::thread::hardware_concurrency()
+    explicit WorkStealingPool(unsigned threadCount = 0);
+    ~WorkStealingPool();
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    // Participating threads, including the caller
+    unsigned threadCount() const { return static_cast<unsigned>(workers.size()) + 1; }
+
+    // Runs fn over every chunk of [0, count) and returns once all are done
+    void parallelFor(std::size_t count, std::size_t chunkSize, const RangeFn &fn);
+
+    // Process-wide pool sized to the machine, created on first use
+    static WorkStealingPool &global();
+
+private:
+    struct Job {
+        const RangeFn *fn = nullptr;
+        std::atomic<std::size_t> remaining{0};
+        std::mutex doneMutex;
+        std::condition_variable done;
+    };
+
+    struct Task {
+        Job *job = nullptr;
+        std::size_t begin = 0;
+        std::size_t end = 0;
+    };
+
+    struct Queue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    void workerLoop(unsigned self);
+    bool takeTask(unsigned self, Task &task);
+    void runTask(const Task &task);
+
+    std::vector<std::unique_ptr<Queue>> queues;   // one per worker, last one for callers
+    std::vector<std::thread> workers;
+
+    std::mutex sleepMutex;
+    std::condition_variable wake;
+    std::atomic<std::size_t> queuedTasks{0};
+    bool stopping = false;
+};
+
+#endif // THREADPOOL_H
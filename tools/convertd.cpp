@@ -0,0 +1,97 @@
+// convertd: binary conversion daemon on a local socket.
+//
+//     convertd [--name NAME] [--workers N] [--max-connections N] [--rates FILE]
+//
+// Speaks the framing in convertprotocol.h; use ConvertClient to talk to it.
+// NAME is a socket name or an absolute path (default "convertd").
+
+#include "convertdaemon.h"
+#include "convertprotocol.h"
+#include "ratespayload.h"
+#include "toolsupport.h"
+#include "units.h"
+
+#include <QCoreApplication>
+#include <QLocalSocket>
+
+#include <cstdio>
+#include <cstring>
+
+namespace {
+
+void printUsage()
+{
+    std::fputs(
+        "usage: convertd [options]\n"
+        "\n"
+        "  -n, --name NAME           local socket name or path (default convertd)\n"
+        "  -w, --workers N           connection threads (default: one per core)\n"
+        "      --max-connections N   refuse clients beyond N with a Busy frame\n"
+        "      --rates FILE          load currency rates from a provider JSON file\n",
+        stderr);
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    ConvertDaemon::Limits limits;
+    QString name = ConvertProtocol::DefaultServerName;
+    const char *ratesPath = nullptr;
+
+    for (int i = 1; i < argc; ++i) {
+        const char *arg = argv[i];
+        const bool hasValue = i + 1 < argc;
+        int count = 0;
+        if ((!std::strcmp(arg, "--name") || !std::strcmp(arg, "-n")) && hasValue) {
+            name = QString::fromLocal8Bit(argv[++i]);
+        } else if ((!std::strcmp(arg, "--workers") || !std::strcmp(arg, "-w")) && hasValue && ToolSupport::parseCount(argv[i + 1], count)) {
+            limits.workers = static_cast<unsigned>(count);
+            ++i;
+        } else if (!std::strcmp(arg, "--max-connections") && hasValue && ToolSupport::parseCount(argv[i + 1], count)) {
+            limits.maxConnections = count;
+            ++i;
+        } else if (!std::strcmp(arg, "--rates") && hasValue) {
+            ratesPath = argv[++i];
+        } else {
+            printUsage();
+            return 2;
+        }
+    }
+
+    if (ratesPath) {
+        RateSnapshot rates;
+        if (RatesPayload::load(QString::fromLocal8Bit(ratesPath), rates) != RatesPayload::Status::Ok) {
+            std::fprintf(stderr, "convertd: cannot load rates from %s\n", ratesPath);
+            return 1;
+        }
+        Units::getInstance().publishRates(std::move(rates));
+    }
+
+    Units::getInstance();   // build the unit tables before the first request
+
+    ConvertDaemon daemon(limits);
+    daemon.setSocketOptions(QLocalServer::UserAccessOption);
+
+    // A socket file nobody answers on is left over from a crashed run and
+    // safe to remove; one that answers belongs to a live daemon
+    QLocalSocket probe;
+    probe.connectToServer(name);
+    if (probe.waitForConnected(1000)) {
+        std::fprintf(stderr, "convertd: another daemon is already listening on %s\n",
+                     name.toLocal8Bit().constData());
+        return 1;
+    }
+    QLocalServer::removeServer(name);
+
+    if (!daemon.listen(name)) {
+        std::fprintf(stderr, "convertd: %s\n", daemon.errorString().toLocal8Bit().constData());
+        return 1;
+    }
+
+    std::fprintf(stderr, "convertd: listening on %s with %u workers\n",
+                 daemon.fullServerName().toLocal8Bit().constData(), daemon.workerCount());
+    return app.exec();
+}
@@ -0,0 +1,92 @@
+// convertserver: local HTTP service in front of the Units engine.
+//
+//     convertserver [--listen ADDR] [--port N] [--workers N]
+//                   [--max-connections N] [--rates FILE]
+//
+// See ConversionServer for the endpoints. Binds to 127.0.0.1 by default;
+// the service is meant for other processes on the same host.
+
+#include "conversionserver.h"
+#include "ratespayload.h"
+#include "toolsupport.h"
+#include "units.h"
+
+#include <QCoreApplication>
+#include <QHostAddress>
+
+#include <cstdio>
+#include <cstring>
+
+namespace {
+
+void printUsage()
+{
+    std::fputs(
+        "usage: convertserver [options]\n"
+        "\n"
+        "  -l, --listen ADDR         address to bind (default 127.0.0.1)\n"
+        "  -p, --port N              TCP port (default 8080)\n"
+        "  -w, --workers N           connection threads (default: one per core)\n"
+        "      --max-connections N   answer 503 beyond N open connections\n"
+        "      --rates FILE          load currency rates from a provider JSON file\n",
+        stderr);
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    ConversionServer::Limits limits;
+    QHostAddress address = QHostAddress::LocalHost;
+    int port = 8080;
+    const char *ratesPath = nullptr;
+
+    for (int i = 1; i < argc; ++i) {
+        const char *arg = argv[i];
+        const bool hasValue = i + 1 < argc;
+        int count = 0;
+        if ((!std::strcmp(arg, "--listen") || !std::strcmp(arg, "-l")) && hasValue) {
+            if (!address.setAddress(QString::fromLocal8Bit(argv[++i]))) {
+                printUsage();
+                return 2;
+            }
+        } else if ((!std::strcmp(arg, "--port") || !std::strcmp(arg, "-p")) && hasValue && ToolSupport::parseCount(argv[i + 1], count) && count < 65536) {
+            port = count;
+            ++i;
+        } else if ((!std::strcmp(arg, "--workers") || !std::strcmp(arg, "-w")) && hasValue && ToolSupport::parseCount(argv[i + 1], count)) {
+            limits.workers = static_cast<unsigned>(count);
+            ++i;
+        } else if (!std::strcmp(arg, "--max-connections") && hasValue && ToolSupport::parseCount(argv[i + 1], count)) {
+            limits.maxConnections = count;
+            ++i;
+        } else if (!std::strcmp(arg, "--rates") && hasValue) {
+            ratesPath = argv[++i];
+        } else {
+            printUsage();
+            return 2;
+        }
+    }
+
+    if (ratesPath) {
+        RateSnapshot rates;
+        if (RatesPayload::load(QString::fromLocal8Bit(ratesPath), rates) != RatesPayload::Status::Ok) {
+            std::fprintf(stderr, "convertserver: cannot load rates from %s\n", ratesPath);
+            return 1;
+        }
+        Units::getInstance().publishRates(std::move(rates));
+    }
+
+    Units::getInstance();   // build the unit tables before the first request
+
+    ConversionServer server(limits);
+    if (!server.listen(address, static_cast<quint16>(port))) {
+        std::fprintf(stderr, "convertserver: %s\n", server.errorString().toLocal8Bit().constData());
+        return 1;
+    }
+
+    std::fprintf(stderr, "convertserver: listening on %s:%d with %u workers\n",
+                 address.toString().toLocal8Bit().constData(), port, server.workerCount());
+    return app.exec();
+}
@@ -0,0 +1,324 @@
+// mockrates: local stand-in for the currency rates provider.
+//
+//     mockrates [--port N] [--currencies N] [--change-every S]
+//               [--no-validators] [--no-compression]
+//               [--delay MS] [--jitter MS] [--fail-rate P] [--drop-rate P]
+//               [--seed N]
+//
+// Serves a provider-style document ({"base": "USD", "rates": {...}}) on
+// any path, with ETag and Last-Modified validators; conditional requests
+// that still match get 304 Not Modified. Bodies are sent deflate-encoded
+// when the client accepts it. Each response is logged to stderr with the
+// bytes it put on the wire, so refresh traffic can be measured.
+//
+// Faults can be injected to exercise hedging and failover: every response
+// waits --delay plus up to --jitter ms, a --fail-rate share get 503, and a
+// --drop-rate share have their connection closed without an answer.
+//
+//     mockrates --port 8090 --delay 40 --jitter 400 --fail-rate 0.1
+//     mockrates --port 8091 --delay 60
+//     rates_refresh_bench --endpoint http://127.0.0.1:8090/latest,http://127.0.0.1:8091/latest
+
+#include "toolsupport.h"
+
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QHash>
+#include <QHostAddress>
+#include <QLocale>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTimer>
+
+#include <charconv>
+#include <cstdio>
+#include <random>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+namespace {
+
+struct Options {
+    quint16 port = 8090;
+    int currencies = 170;
+    int changeEverySeconds = 0;     // 0: the document never changes
+    bool validators = true;
+    bool compression = true;
+
+    // Fault injection
+    int delayMs = 0;
+    int jitterMs = 0;
+    double failRate = 0.0;
+    double dropRate = 0.0;
+    unsigned seed = 1;
+};
+
+void printUsage()
+{
+    std::fputs(
+        "usage: mockrates [options]\n"
+        "\n"
+        "  -p, --port N              TCP port on 127.0.0.1 (default 8090)\n"
+        "  -c, --currencies N        currencies in the document (default 170)\n"
+        "      --change-every S      move some rates every S seconds\n"
+        "      --no-validators       send no ETag/Last-Modified (no 304s)\n"
+        "      --no-compression      always send the body uncompressed\n"
+        "      --delay MS            wait MS before each response\n"
+        "      --jitter MS           plus a uniform random 0..MS\n"
+        "      --fail-rate P         answer this share of requests with 503\n"
+        "      --drop-rate P         close this share of connections unanswered\n"
+        "      --seed N              seed for the fault injection (default 1)\n",
+        stderr);
+}
+
+bool parseRate(const char *text, double &out)
+{
+    char *end = nullptr;
+    const double value = std::strtod(text, &end);
+    if (end == text || *end != '\0' || !(value >= 0.0 && value <= 1.0)) return false;
+    out = value;
+    return true;
+}
+
+/* ===================== DOCUMENT ===================== */
+
+class RatesDocument
+{
+public:
+    explicit RatesDocument(int currencies)
+    {
+        const char *known[] = {"EUR", "ZAR", "GBP", "JPY"};
+        for (int i = 0; i < currencies; ++i) {
+            codes.push_back(i < 4 ? QByteArray(known[i]) : "C" + QByteArray::number(i).rightJustified(3, '0'));
+            rates.push_back(0.5 + i * 0.01);
+        }
+        rebuild();
+    }
+
+    // Moves every tenth rate by 0.1%, as a provider update would
+    void change()
+    {
+        for (std::size_t i = generation % 10; i < rates.size(); i += 10)
+            rates[i] *= 1.001;
+        rebuild();
+    }
+
+    QByteArray body;
+    QByteArray deflated;
+    QByteArray etag;
+    QByteArray lastModified;
+
+private:
+    void rebuild()
+    {
+        ++generation;
+        body = "{\"base\":\"USD\",\"rates\":{";
+        char number[32];
+        for (std::size_t i = 0; i < rates.size(); ++i) {
+            const auto r = std::to_chars(number, number + sizeof(number), rates[i]);
+            body += (i ? ",\"" : "\"") + codes[i] + "\":" + QByteArray(number, r.ptr - number);
+        }
+        body += "}}";
+
+        // zlib-wrapped deflate, which is what HTTP "deflate" means
+        deflated = qCompress(body, 9).mid(4);
+        etag = "\"r" + QByteArray::number(generation) + "\"";
+        lastModified = QLocale::c().toString(QDateTime::currentDateTimeUtc(),
+                                             "ddd, dd MMM yyyy hh:mm:ss 'GMT'").toLatin1();
+    }
+
+    std::vector<QByteArray> codes;
+    std::vector<double> rates;
+    quint64 generation = 0;
+};
+
+/* ===================== SERVER ===================== */
+
+class MockServer
+{
+public:
+    MockServer(const Options &options, RatesDocument &document)
+        : options(options), document(document), random(options.seed) {}
+
+    bool listen()
+    {
+        QObject::connect(&server, &QTcpServer::newConnection, [this]() {
+            while (QTcpSocket *socket = server.nextPendingConnection()) {
+                QObject::connect(socket, &QTcpSocket::readyRead, [this, socket]() { serve(socket); });
+                QObject::connect(socket, &QTcpSocket::disconnected, [this, socket]() {
+                    pending.remove(socket);
+                    socket->deleteLater();
+                });
+            }
+        });
+        return server.listen(QHostAddress::LocalHost, options.port);
+    }
+
+    QString errorString() const { return server.errorString(); }
+
+private:
+    // Answers every complete request buffered on the socket (GETs only)
+    void serve(QTcpSocket *socket)
+    {
+        QByteArray &buffer = pending[socket];
+        buffer += socket->readAll();
+
+        qsizetype end;
+        while ((end = buffer.indexOf("\r\n\r\n")) >= 0) {
+            const QByteArray head = buffer.left(end);
+            buffer.remove(0, end + 4);
+            respond(socket, head);
+        }
+        if (buffer.size() > 64 * 1024) socket->abort();
+    }
+
+    void respond(QTcpSocket *socket, const QByteArray &head)
+    {
+        const QList<QByteArray> lines = head.split('\n');
+        const QByteArray requestLine = lines.value(0).trimmed();
+        QByteArray ifNoneMatch, ifModifiedSince, acceptEncoding, connection;
+        for (qsizetype i = 1; i < lines.size(); ++i) {
+            const qsizetype colon = lines[i].indexOf(':');
+            if (colon < 0) continue;
+            const QByteArray name = lines[i].left(colon).trimmed().toLower();
+            const QByteArray value = lines[i].mid(colon + 1).trimmed();
+            if (name == "if-none-match") ifNoneMatch = value;
+            else if (name == "if-modified-since") ifModifiedSince = value;
+            else if (name == "accept-encoding") acceptEncoding = value.toLower();
+            else if (name == "connection") connection = value.toLower();
+        }
+
+        // Faults are decided up front so the log says what the client saw
+        std::uniform_real_distribution<double> chance(0.0, 1.0);
+        const bool drop = chance(random) < options.dropRate;
+        const bool fail = !drop && chance(random) < options.failRate;
+        const int delay = options.delayMs
+            + (options.jitterMs > 0 ? std::uniform_int_distribution<int>(0, options.jitterMs)(random) : 0);
+        const bool close = connection == "close";
+
+        if (drop) {
+            QTimer::singleShot(delay, socket, [socket]() { socket->abort(); });
+            log(requestLine, "dropped", delay, 0);
+            return;
+        }
+        if (fail) {
+            const QByteArray response = close
+                ? "HTTP/1.1 503 Service Unavailable\r\nContent-Length: 0\r\nConnection: close\r\n\r\n"
+                : "HTTP/1.1 503 Service Unavailable\r\nContent-Length: 0\r\n\r\n";
+            send(socket, response, close, delay);
+            log(requestLine, "503", delay, response.size());
+            return;
+        }
+
+        const bool notModified = options.validators
+            && ((!ifNoneMatch.isEmpty() && ifNoneMatch == document.etag)
+                || (ifNoneMatch.isEmpty() && !ifModifiedSince.isEmpty() && ifModifiedSince == document.lastModified));
+        const bool deflate = options.compression && acceptEncoding.contains("deflate");
+        const QByteArray &body = notModified ? QByteArray() : deflate ? document.deflated : document.body;
+
+        QByteArray response = notModified ? "HTTP/1.1 304 Not Modified\r\n" : "HTTP/1.1 200 OK\r\n";
+        if (options.validators)
+            response += "ETag: " + document.etag + "\r\nLast-Modified: " + document.lastModified + "\r\n";
+        if (!notModified) {
+            response += "Content-Type: application/json\r\n";
+            if (deflate) response += "Content-Encoding: deflate\r\n";
+            response += "Content-Length: " + QByteArray::number(body.size()) + "\r\n";
+        }
+        response += close ? "Connection: close\r\n\r\n" : "\r\n";
+        response += body;
+        send(socket, response, close, delay);
+        log(requestLine, notModified ? "304" : deflate ? "200 deflate" : "200", delay, response.size());
+    }
+
+    // Responses on one connection keep their order: QNetworkAccessManager
+    // does not pipeline, so at most one is pending per socket
+    void send(QTcpSocket *socket, const QByteArray &response, bool close, int delayMs)
+    {
+        auto write = [socket, response, close]() {
+            socket->write(response);
+            if (close) socket->disconnectFromHost();
+        };
+        if (delayMs > 0) QTimer::singleShot(delayMs, socket, write);
+        else write();
+    }
+
+    void log(const QByteArray &requestLine, const char *outcome, int delayMs, qsizetype size)
+    {
+        ++requests;
+        bytes += static_cast<quint64>(size);
+        std::fprintf(stderr, "%s -> %s after %d ms, %lld bytes (total %llu requests, %llu bytes)\n",
+                     requestLine.constData(), outcome, delayMs, static_cast<long long>(size),
+                     static_cast<unsigned long long>(requests), static_cast<unsigned long long>(bytes));
+    }
+
+    const Options options;
+    RatesDocument &document;
+    QTcpServer server;
+    QHash<QTcpSocket *, QByteArray> pending;
+    std::mt19937 random;
+    quint64 requests = 0;
+    quint64 bytes = 0;
+};
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+        const char *arg = argv[i];
+        const bool hasValue = i + 1 < argc;
+        int count = 0;
+        if ((!std::strcmp(arg, "--port") || !std::strcmp(arg, "-p")) && hasValue && ToolSupport::parseCount(argv[i + 1], count) && count <= 65535) {
+            options.port = static_cast<quint16>(count);
+            ++i;
+        } else if ((!std::strcmp(arg, "--currencies") || !std::strcmp(arg, "-c")) && hasValue && ToolSupport::parseCount(argv[i + 1], count)) {
+            options.currencies = count;
+            ++i;
+        } else if (!std::strcmp(arg, "--change-every") && hasValue && ToolSupport::parseCount(argv[i + 1], count)) {
+            options.changeEverySeconds = count;
+            ++i;
+        } else if (!std::strcmp(arg, "--delay") && hasValue && ToolSupport::parseCount(argv[i + 1], count)) {
+            options.delayMs = count;
+            ++i;
+        } else if (!std::strcmp(arg, "--jitter") && hasValue && ToolSupport::parseCount(argv[i + 1], count)) {
+            options.jitterMs = count;
+            ++i;
+        } else if (!std::strcmp(arg, "--fail-rate") && hasValue && parseRate(argv[i + 1], options.failRate)) {
+            ++i;
+        } else if (!std::strcmp(arg, "--drop-rate") && hasValue && parseRate(argv[i + 1], options.dropRate)) {
+            ++i;
+        } else if (!std::strcmp(arg, "--seed") && hasValue && ToolSupport::parseCount(argv[i + 1], count)) {
+            options.seed = static_cast<unsigned>(count);
+            ++i;
+        } else if (!std::strcmp(arg, "--no-validators")) {
+            options.validators = false;
+        } else if (!std::strcmp(arg, "--no-compression")) {
+            options.compression = false;
+        } else {
+            printUsage();
+            return 2;
+        }
+    }
+
+    RatesDocument document(options.currencies);
+    MockServer server(options, document);
+    if (!server.listen()) {
+        std::fprintf(stderr, "mockrates: %s\n", server.errorString().toLocal8Bit().constData());
+        return 1;
+    }
+
+    QTimer changes;
+    if (options.changeEverySeconds > 0) {
+        QObject::connect(&changes, &QTimer::timeout, [&document]() { document.change(); });
+        changes.start(options.changeEverySeconds * 1000);
+    }
+
+    std::fprintf(stderr, "mockrates: serving %d currencies on http://127.0.0.1:%u/latest (%zu bytes, %zu deflated)\n",
+                 options.currencies, static_cast<unsigned>(options.port),
+                 static_cast<std::size_t>(document.body.size()), static_cast<std::size_t>(document.deflated.size()));
+    return app.exec();
+}
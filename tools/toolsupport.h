@@ -0,0 +1,22 @@
+#ifndef TOOLSUPPORT_H
+#define TOOLSUPPORT_H
+
+#include <cstdlib>
+
+// Argument parsing shared by the command-line tools and benchmarks
+namespace ToolSupport {
+
+// Whole positive decimal number no larger than `max`; false for null
+inline bool parseCount(const char *text, int &out, long max = 1 << 20)
+{
+    if (!text) return false;
+    char *end = nullptr;
+    const long value = std::strtol(text, &end, 10);
+    if (end == text || *end != '\0' || value <= 0 || value > max) return false;
+    out = static_cast<int>(value);
+    return true;
+}
+
+} // namespace ToolSupport
+
+#endif // TOOLSUPPORT_H
@@ -0,0 +1,412 @@
+// unitconv: headless streaming front end for the Units engine.
+//
+//     unitconv --from Miles --to Feet [options] [FILE...]
+//
+// Reads numbers (one per line) or, with --column, one field of each CSV
+// row from the given files or stdin, and writes the converted stream to
+// stdout. Input is processed in fixed-size blocks whose lines are parsed,
+// converted and formatted in parallel, so memory stays bounded by the
+// block size and the longest line, however large the input is.
+//
+// With --binary the input is a raw little-endian float/double array that
+// is memory-mapped and converted into --output (or --in-place) instead.
+
+#include "units.h"
+#include "threadpool.h"
+#include "mappedconvert.h"
+#include "unitcatalog.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+
+constexpr std::size_t BlockSize = 1 << 20;   // per thread
+
+constexpr int MaxPrecision = 30;
+
+struct Options {
+    QString from;
+    QString to;
+    int column = 0;             // 1-based CSV column, 0 = whole line
+    char delimiter = ',';
+    bool header = false;        // pass the first line through untouched
+    int precision = -1;         // -1 = shortest round-trip form
+    bool binary = false;        // raw array mode
+    MappedConvert::ElementType elementType = MappedConvert::ElementType::Float64;
+    const char *output = nullptr;
+    bool inPlace = false;
+    std::vector<const char *> files;
+};
+
+void printUsage()
+{
+    std::fputs(
+        "usage: unitconv --from UNIT --to UNIT [options] [FILE...]\n"
+        "\n"
+        "  -f, --from UNIT       source unit (e.g. Miles)\n"
+        "  -t, --to UNIT         target unit (e.g. Feet)\n"
+        "  -c, --column N        convert field N (1-based) of each CSV row\n"
+        "  -d, --delimiter C     CSV field delimiter (default ',')\n"
+        "      --header          copy the first line of each input unchanged\n"
+        "  -p, --precision N     fixed digits after the point (default: shortest)\n"
+        "      --list            list known units and exit\n"
+        "\n"
+        "Binary arrays (raw little-endian, memory-mapped):\n"
+        "  -b, --binary f64|f32  treat the single FILE as a raw array\n"
+        "  -o, --output FILE     write the converted array to FILE\n"
+        "      --in-place        overwrite the input array instead\n"
+        "\n"
+        "Reads stdin when no FILE is given or FILE is '-'.\n",
+        stderr);
+}
+
+/* ===================== FORMATTING ===================== */
+
+void appendNumber(std::string &out, double value, int precision)
+{
+    // Room for -DBL_MAX in fixed form: sign, 309 digits, point, decimals
+    char digits[1 + std::numeric_limits<double>::max_exponent10 + 1 + 1 + MaxPrecision];
+    std::to_chars_result r = precision < 0
+        ? std::to_chars(digits, digits + sizeof(digits), value)
+        : std::to_chars(digits, digits + sizeof(digits), value, std::chars_format::fixed, precision);
+    if (r.ec != std::errc())
+        r = std::to_chars(digits, digits + sizeof(digits), value);     // shortest form always fits
+    out.append(digits, static_cast<std::size_t>(r.ptr - digits));
+}
+
+/* ===================== PARSING ===================== */
+
+std::string_view trim(std::string_view s)
+{
+    while (!s.empty() && (s.front() == ' ' || s.front() == '\t')) s.remove_prefix(1);
+    while (!s.empty() && (s.back() == ' ' || s.back() == '\t' || s.back() == '\r')) s.remove_suffix(1);
+    return s;
+}
+
+bool parseNumber(std::string_view text, double &value)
+{
+    text = trim(text);
+    if (!text.empty() && text.front() == '+') text.remove_prefix(1);
+    if (text.empty()) return false;
+
+    std::from_chars_result r = std::from_chars(text.data(), text.data() + text.size(), value);
+    return r.ec == std::errc() && r.ptr == text.data() + text.size();
+}
+
+/* ===================== CONVERSION ===================== */
+
+// Converts complete lines into an output string. One instance per segment,
+// so segments can run on different threads.
+class LineConverter
+{
+public:
+    LineConverter(const Options &options, const ConversionPlan &conversion, std::string &output)
+        : opts(options), plan(conversion), out(output) {}
+
+    std::size_t badValues = 0;
+
+    void convertLines(std::string_view text) {
+        std::size_t start = 0;
+        while (start < text.size()) {
+            std::size_t end = text.find('\n', start);
+            if (end == std::string_view::npos) end = text.size();
+            convertLine(text.substr(start, end - start));
+            start = end + 1;
+        }
+    }
+
+    void convertLine(std::string_view line) {
+        if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+
+        if (opts.column == 0) {
+            convertField(line);
+            out.push_back('\n');
+            return;
+        }
+
+        // Copy every field through, converting only the selected one
+        int field = 1;
+        std::size_t start = 0;
+        for (;;) {
+            std::size_t end = line.find(opts.delimiter, start);
+            std::string_view text = line.substr(start, end == std::string_view::npos ? line.size() - start : end - start);
+            if (field == opts.column) convertField(text);
+            else out.append(text);
+
+            if (end == std::string_view::npos) break;
+            out.push_back(opts.delimiter);
+            start = end + 1;
+            ++field;
+        }
+        if (field < opts.column) ++badValues;   // row too short
+        out.push_back('\n');
+    }
+
+private:
+    void convertField(std::string_view text) {
+        double value = 0.0;
+        if (parseNumber(text, value)) {
+            appendNumber(out, plan.apply(value), opts.precision);
+        } else {
+            if (!trim(text).empty()) ++badValues;
+            out.append(text);
+        }
+    }
+
+    const Options &opts;
+    const ConversionPlan &plan;
+    std::string &out;
+};
+
+// Streams one input through the converter a block at a time. Each block's
+// complete lines are cut into segments at line boundaries and converted in
+// parallel; segment outputs are written back in input order.
+class StreamConverter
+{
+public:
+    StreamConverter(const Options &options, const ConversionPlan &conversion, WorkStealingPool &workers)
+        : opts(options), plan(conversion), pool(workers), outputs(pool.threadCount() * SegmentsPerThread),
+          badCounts(outputs.size()) {}
+
+    std::size_t badValues = 0;
+
+    bool convert(std::FILE *in, std::FILE *out) {
+        std::vector<char> buffer(BlockSize * pool.threadCount());
+        std::size_t carried = 0;       // bytes of an unfinished line kept from the last block
+        bool skipHeader = opts.header;
+
+        for (;;) {
+            if (carried == buffer.size())
+                buffer.resize(buffer.size() * 2);   // a single line longer than the block
+
+            const std::size_t got = std::fread(buffer.data() + carried, 1, buffer.size() - carried, in);
+            const std::size_t filled = carried + got;
+            const bool atEnd = got == 0;
+
+            std::string_view data(buffer.data(), filled);
+            std::size_t complete = atEnd ? filled : data.rfind('\n') + 1;  // npos + 1 == 0
+
+            std::string_view region = data.substr(0, complete);
+            if (skipHeader && !region.empty()) {
+                std::size_t nl = region.find('\n');
+                std::string_view header = region.substr(0, nl);
+                std::fwrite(header.data(), 1, header.size(), out);
+                std::fputc('\n', out);
+                region.remove_prefix(nl == std::string_view::npos ? region.size() : nl + 1);
+                skipHeader = false;
+            }
+            convertRegion(region, out);
+
+            if (atEnd)
+                return !std::ferror(in);
+
+            carried = filled - complete;
+            std::memmove(buffer.data(), buffer.data() + complete, carried);
+        }
+    }
+
+private:
+    static constexpr std::size_t SegmentsPerThread = 4;
+
+    void convertRegion(std::string_view region, std::FILE *out) {
+        if (region.empty()) return;
+
+        // Cut at line boundaries into roughly equal segments
+        std::vector<std::string_view> segments;
+        const std::size_t target = std::max<std::size_t>(region.size() / outputs.size(), 4096);
+        std::size_t start = 0;
+        while (start < region.size()) {
+            std::size_t end = std::min(region.size(), start + target);
+            if (end < region.size()) {
+                std::size_t nl = region.find('\n', end);
+                end = nl == std::string_view::npos ? region.size() : nl + 1;
+            }
+            segments.push_back(region.substr(start, end - start));
+            start = end;
+        }
+
+        if (segments.size() > outputs.size()) {
+            outputs.resize(segments.size());
+            badCounts.resize(segments.size());
+        }
+
+        pool.parallelFor(segments.size(), 1, [&](std::size_t begin, std::size_t end) {
+            for (std::size_t i = begin; i < end; ++i) {
+                outputs[i].clear();
+                LineConverter converter(opts, plan, outputs[i]);
+                converter.convertLines(segments[i]);
+                badCounts[i] = converter.badValues;
+            }
+        });
+
+        for (std::size_t i = 0; i < segments.size(); ++i) {
+            std::fwrite(outputs[i].data(), 1, outputs[i].size(), out);
+            badValues += badCounts[i];
+        }
+    }
+
+    const Options &opts;
+    const ConversionPlan &plan;
+    WorkStealingPool &pool;
+    std::vector<std::string> outputs;       // reused across blocks
+    std::vector<std::size_t> badCounts;
+};
+
+bool parseArguments(int argc, char *argv[], Options &opts, bool &list)
+{
+    for (int i = 1; i < argc; ++i) {
+        std::string_view arg = argv[i];
+        auto value = [&]() -> const char * { return i + 1 < argc ? argv[++i] : nullptr; };
+
+        if (arg == "-f" || arg == "--from") {
+            const char *v = value(); if (!v) return false;
+            opts.from = QString::fromUtf8(v);
+        } else if (arg == "-t" || arg == "--to") {
+            const char *v = value(); if (!v) return false;
+            opts.to = QString::fromUtf8(v);
+        } else if (arg == "-c" || arg == "--column") {
+            const char *v = value(); if (!v) return false;
+            opts.column = std::atoi(v);
+            if (opts.column < 1) return false;
+        } else if (arg == "-d" || arg == "--delimiter") {
+            const char *v = value(); if (!v || std::strlen(v) != 1) return false;
+            opts.delimiter = v[0];
+        } else if (arg == "-p" || arg == "--precision") {
+            const char *v = value(); if (!v) return false;
+            opts.precision = std::atoi(v);
+            if (opts.precision < 0 || opts.precision > MaxPrecision) return false;
+        } else if (arg == "-b" || arg == "--binary") {
+            const char *v = value(); if (!v) return false;
+            std::string_view type = v;
+            if (type == "f64") opts.elementType = MappedConvert::ElementType::Float64;
+            else if (type == "f32") opts.elementType = MappedConvert::ElementType::Float32;
+            else return false;
+            opts.binary = true;
+        } else if (arg == "-o" || arg == "--output") {
+            opts.output = value();
+            if (!opts.output) return false;
+        } else if (arg == "--in-place") {
+            opts.inPlace = true;
+        } else if (arg == "--header") {
+            opts.header = true;
+        } else if (arg == "--list") {
+            list = true;
+        } else if (arg == "-h" || arg == "--help") {
+            return false;
+        } else if (arg.size() > 1 && arg.front() == '-' && arg != "-") {
+            std::fprintf(stderr, "unitconv: unknown option %s\n", argv[i]);
+            return false;
+        } else {
+            opts.files.push_back(argv[i]);
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    Options opts;
+    bool list = false;
+    if (!parseArguments(argc, argv, opts, list)) {
+        printUsage();
+        return 2;
+    }
+
+    Units &units = Units::getInstance();
+
+    const UnitCatalog &catalog = UnitCatalog::builtin();
+
+    if (list) {
+        for (std::size_t id = 0; id < units.unitCount(); ++id)
+            std::printf("%s\n", units.unitName(static_cast<UnitId>(id)).toUtf8().constData());
+        for (CatalogId id = 0; id < catalog.size(); ++id) {
+            const std::string_view symbol = catalog.symbol(id);
+            const std::string_view name = catalog.name(id);
+            std::printf("%.*s\t%.*s\t%s\n", int(symbol.size()), symbol.data(), int(name.size()), name.data(),
+                        UnitCatalog::kindName(catalog.kind(id)));
+        }
+        return 0;
+    }
+
+    if (opts.from.isEmpty() || opts.to.isEmpty()) {
+        printUsage();
+        return 2;
+    }
+
+    auto known = [&](const QString &name) {
+        return units.unitId(name) != InvalidUnitId || catalog.find(name) != InvalidCatalogId;
+    };
+    if (!known(opts.from) || !known(opts.to)) {
+        std::fprintf(stderr, "unitconv: unknown unit '%s'\n",
+                     (known(opts.from) ? opts.to : opts.from).toUtf8().constData());
+        return 2;
+    }
+
+    const ConversionPlan plan = units.plan(opts.from, opts.to);
+    if (!plan.isValid()) {
+        std::fprintf(stderr, "unitconv: cannot convert %s to %s\n",
+                     opts.from.toUtf8().constData(), opts.to.toUtf8().constData());
+        return 2;
+    }
+
+    if (opts.binary) {
+        if (opts.files.size() != 1 || std::strcmp(opts.files.front(), "-") == 0
+            || (opts.output == nullptr) == !opts.inPlace) {
+            std::fputs("unitconv: --binary needs one input FILE and either --output or --in-place\n", stderr);
+            return 2;
+        }
+
+        const QString input = QString::fromLocal8Bit(opts.files.front());
+        QString error;
+        const bool converted = opts.inPlace
+            ? MappedConvert::convertFileInPlace(input, plan, opts.elementType, &error)
+            : MappedConvert::convertFile(input, QString::fromLocal8Bit(opts.output), plan, opts.elementType, &error);
+        if (!converted) {
+            std::fprintf(stderr, "unitconv: %s\n", error.toLocal8Bit().constData());
+            return 1;
+        }
+        return 0;
+    }
+
+    // Full output buffering; every write is already a whole segment
+    std::setvbuf(stdout, nullptr, _IOFBF, BlockSize);
+
+    StreamConverter converter(opts, plan, WorkStealingPool::global());
+
+    if (opts.files.empty())
+        opts.files.push_back("-");
+
+    bool ok = true;
+    for (const char *path : opts.files) {
+        const bool isStdin = std::strcmp(path, "-") == 0;
+        std::FILE *in = isStdin ? stdin : std::fopen(path, "rb");
+        if (!in) {
+            std::fprintf(stderr, "unitconv: cannot open %s\n", path);
+            ok = false;
+            continue;
+        }
+        if (!converter.convert(in, stdout)) {
+            std::fprintf(stderr, "unitconv: read error on %s\n", path);
+            ok = false;
+        }
+        if (!isStdin) std::fclose(in);
+    }
+    std::fflush(stdout);
+
+    if (converter.badValues > 0) {
+        std::fprintf(stderr, "unitconv: %zu value(s) could not be parsed and were copied unchanged\n",
+                     converter.badValues);
+        return 1;
+    }
+    return ok ? 0 : 1;
+}
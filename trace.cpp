@@ -0,0 +1,233 @@
+#include "trace.h"
+
+#include <QCoreApplication>
+#include <QThread>
+
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+const Clock::time_point epoch = Clock::now();
+
+enum class Kind : std::uint8_t { Complete, Instant, Async };
+
+struct Event {
+    const char *name;
+    std::uint64_t begin;
+    std::uint64_t end;
+    std::int64_t arg;
+    std::uint64_t id;
+    Kind kind;
+};
+
+// Fixed-size block of events. Only the owning thread appends; `count` is
+// published with release so the writer at exit reads complete events only.
+struct Chunk {
+    static constexpr std::size_t Capacity = 4096;
+
+    std::array<Event, Capacity> events;
+    std::atomic<std::size_t> count{0};
+    std::atomic<Chunk *> next{nullptr};
+};
+
+struct ThreadBuffer {
+    // Far more than any session records; past it events are counted, not kept
+    static constexpr std::size_t MaxChunks = 256;
+
+    std::string threadName;
+    std::uint32_t tid = 0;
+    Chunk head;
+    Chunk *tail = &head;            // owner thread only
+    std::size_t chunks = 1;         // owner thread only
+    std::atomic<std::uint64_t> dropped{0};
+
+    ~ThreadBuffer() {
+        for (Chunk *c = head.next.load(); c;) {
+            Chunk *next = c->next.load();
+            delete c;
+            c = next;
+        }
+    }
+
+    void append(const Event &e) {
+        std::size_t n = tail->count.load(std::memory_order_relaxed);
+        if (n == Chunk::Capacity) {
+            if (chunks == MaxChunks) {
+                dropped.store(dropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+                return;
+            }
+            Chunk *c = new Chunk;
+            tail->next.store(c, std::memory_order_release);
+            tail = c;
+            ++chunks;
+            n = 0;
+        }
+        tail->events[n] = e;
+        tail->count.store(n + 1, std::memory_order_release);
+    }
+};
+
+// Owns every buffer ever handed out; a mutex is taken once per thread
+struct Registry {
+    std::mutex mutex;
+    std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+    std::string path;
+
+    ThreadBuffer *acquire() {
+        QThread *thread = QThread::currentThread();
+        QString name = thread ? thread->objectName() : QString();
+        if (name.isEmpty() && QCoreApplication::instance() && thread == QCoreApplication::instance()->thread())
+            name = "main";
+
+        std::lock_guard<std::mutex> lock(mutex);
+        auto buffer = std::make_unique<ThreadBuffer>();
+        buffer->tid = static_cast<std::uint32_t>(buffers.size() + 1);
+        buffer->threadName = name.isEmpty() ? "thread " + std::to_string(buffer->tid) : name.toStdString();
+        buffers.push_back(std::move(buffer));
+        return buffers.back().get();
+    }
+};
+
+Registry &registry() {
+    static Registry r;
+    return r;
+}
+
+ThreadBuffer &localBuffer() {
+    thread_local ThreadBuffer *buffer = registry().acquire();
+    return *buffer;
+}
+
+void writeAtExit() {
+    Trace::write();
+}
+
+void printJsonString(std::FILE *f, const std::string &s) {
+    std::fputc('"', f);
+    for (char c : s) {
+        if (c == '"' || c == '\\') std::fputc('\\', f);
+        if (static_cast<unsigned char>(c) >= 0x20) std::fputc(c, f);
+    }
+    std::fputc('"', f);
+}
+
+void printMicros(std::FILE *f, std::uint64_t ns) {
+    std::fprintf(f, "%llu.%03llu", static_cast<unsigned long long>(ns / 1000),
+                 static_cast<unsigned long long>(ns % 1000));
+}
+
+} // namespace
+
+std::atomic<bool> Trace::enabled{[]() {
+    const char *env = std::getenv("CONVERTER_TRACE");
+    if (!env || !*env) return false;
+    registry().path = env;
+    std::atexit(writeAtExit);
+    return true;
+}()};
+
+void Trace::start(const std::string &path) {
+    Registry &r = registry();
+    {
+        std::lock_guard<std::mutex> lock(r.mutex);
+        const bool registered = !r.path.empty();
+        r.path = path;
+        if (!registered) std::atexit(writeAtExit);
+    }
+    enabled.store(true, std::memory_order_relaxed);
+}
+
+std::uint64_t Trace::now() {
+    return static_cast<std::uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - epoch).count());
+}
+
+/* ===================== RECORDING ===================== */
+
+void Trace::complete(const char *name, std::uint64_t beginNs, std::uint64_t endNs, std::int64_t arg) {
+    if (!isEnabled()) return;
+    localBuffer().append({name, beginNs, endNs, arg, 0, Kind::Complete});
+}
+
+void Trace::instant(const char *name) {
+    if (!isEnabled()) return;
+    const std::uint64_t t = now();
+    localBuffer().append({name, t, t, NoArg, 0, Kind::Instant});
+}
+
+void Trace::async(const char *name, std::uint64_t id, std::uint64_t beginNs, std::uint64_t endNs) {
+    if (!isEnabled()) return;
+    localBuffer().append({name, beginNs, endNs, NoArg, id, Kind::Async});
+}
+
+/* ===================== OUTPUT ===================== */
+
+// Chrome trace event format; timestamps are microseconds with ns decimals
+bool Trace::write() {
+    Registry &r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    if (r.path.empty()) return false;
+
+    std::FILE *f = std::fopen(r.path.c_str(), "w");
+    if (!f) return false;
+
+    std::fputs("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n", f);
+    bool first = true;
+    auto separator = [&]() {
+        if (!first) std::fputs(",\n", f);
+        first = false;
+    };
+
+    for (const auto &buffer : r.buffers) {
+        separator();
+        std::fprintf(f, "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":", buffer->tid);
+        printJsonString(f, buffer->threadName);
+        std::fputs("}}", f);
+
+        for (const Chunk *c = &buffer->head; c; c = c->next.load(std::memory_order_acquire)) {
+            const std::size_t count = c->count.load(std::memory_order_acquire);
+            for (std::size_t i = 0; i < count; ++i) {
+                const Event &e = c->events[i];
+                separator();
+                switch (e.kind) {
+                case Kind::Complete:
+                    std::fprintf(f, "{\"ph\":\"X\",\"name\":\"%s\",\"pid\":1,\"tid\":%u,\"ts\":", e.name, buffer->tid);
+                    printMicros(f, e.begin);
+                    std::fputs(",\"dur\":", f);
+                    printMicros(f, e.end - e.begin);
+                    if (e.arg != NoArg)
+                        std::fprintf(f, ",\"args\":{\"arg\":%lld}", static_cast<long long>(e.arg));
+                    std::fputc('}', f);
+                    break;
+                case Kind::Instant:
+                    std::fprintf(f, "{\"ph\":\"i\",\"s\":\"t\",\"name\":\"%s\",\"pid\":1,\"tid\":%u,\"ts\":", e.name, buffer->tid);
+                    printMicros(f, e.begin);
+                    std::fputc('}', f);
+                    break;
+                case Kind::Async:
+                    for (const char *ph : {"b", "e"}) {
+                        if (*ph == 'e') std::fputs(",\n", f);
+                        std::fprintf(f, "{\"ph\":\"%s\",\"cat\":\"async\",\"name\":\"%s\",\"id\":%llu,\"pid\":1,\"tid\":%u,\"ts\":",
+                                     ph, e.name, static_cast<unsigned long long>(e.id), buffer->tid);
+                        printMicros(f, *ph == 'b' ? e.begin : e.end);
+                        std::fputc('}', f);
+                    }
+                    break;
+                }
+            }
+        }
+        if (const std::uint64_t dropped = buffer->dropped.load(std::memory_order_relaxed))
+            std::fprintf(stderr, "trace: %llu events dropped on %s\n",
+                         static_cast<unsigned long long>(dropped), buffer->threadName.c_str());
+    }
+    std::fputs("\n]}\n", f);
+    return std::fclose(f) == 0;
+}
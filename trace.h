@@ -0,0 +1,68 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+// Opt-in span tracing, written as Chrome / Perfetto trace JSON.
+//
+// Disabled by default: a TRACE_SCOPE then costs one relaxed atomic load.
+// Enable with CONVERTER_TRACE=<file.json> in the environment or
+// Trace::start(path); the trace is written to the file at exit (or by
+// Trace::write()) and opens in chrome://tracing or ui.perfetto.dev.
+//
+// Events go into a buffer owned by the recording thread: appending never
+// locks and never touches another thread's cache lines. Buffers outlive
+// their threads, so spans recorded on worker threads are kept. Names must
+// be string literals (or otherwise live for the whole process).
+class Trace
+{
+public:
+    static constexpr std::int64_t NoArg = INT64_MIN;
+
+    static bool isEnabled() { return enabled.load(std::memory_order_relaxed); }
+    static void start(const std::string &path);
+    static bool write();
+
+    // Nanoseconds on the trace clock (steady, zero near process start)
+    static std::uint64_t now();
+
+    // -------- recording --------
+    // A span on the calling thread's track
+    static void complete(const char *name, std::uint64_t beginNs, std::uint64_t endNs, std::int64_t arg = NoArg);
+    // A point in time on the calling thread's track
+    static void instant(const char *name);
+    // A span on its own track, for work that overlaps other spans on the
+    // same thread (e.g. concurrent network requests); `id` pairs its ends
+    static void async(const char *name, std::uint64_t id, std::uint64_t beginNs, std::uint64_t endNs);
+
+    class Scope
+    {
+    public:
+        explicit Scope(const char *name, std::int64_t arg = NoArg)
+            : name(isEnabled() ? name : nullptr), arg(arg), begin(this->name ? now() : 0) {}
+        ~Scope() { if (name) complete(name, begin, now(), arg); }
+
+        Scope(const Scope &) = delete;
+        Scope &operator=(const Scope &) = delete;
+
+    private:
+        const char *name;
+        std::int64_t arg;
+        std::uint64_t begin;
+    };
+
+private:
+    static std::atomic<bool> enabled;
+};
+
+#define TRACE_CONCAT_(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_(a, b)
+
+// Records the enclosing scope as a span
+#define TRACE_SCOPE(name) Trace::Scope TRACE_CONCAT(traceScope, __LINE__)(name)
+// Same, with an integer shown as the span's argument
+#define TRACE_SCOPE_ARG(name, arg) Trace::Scope TRACE_CONCAT(traceScope, __LINE__)(name, static_cast<std::int64_t>(arg))
+
+#endif // TRACE_H
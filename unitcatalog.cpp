@@ -0,0 +1,490 @@
+#include "unitcatalog.h"
+#include "utf8.h"
+
+#include <bit>
+#include <cmath>
+#include <cstring>
+#include <iterator>
+#include <numbers>
+
+namespace {
+
+using Kind = UnitCatalog::Kind;
+
+/* ===================== PREFIXES ===================== */
+
+struct Prefix {
+    const char *symbol;
+    const char *name;
+    int exponent;               // of 10, or of 1024 for binary prefixes
+    bool binary;
+    const char *symbolAliases;  // '|'-separated
+};
+
+constexpr Prefix Prefixes[] = {
+    {"Q", "quetta", 30, false, ""},
+    {"R", "ronna", 27, false, ""},
+    {"Y", "yotta", 24, false, ""},
+    {"Z", "zetta", 21, false, ""},
+    {"E", "exa", 18, false, ""},
+    {"P", "peta", 15, false, ""},
+    {"T", "tera", 12, false, ""},
+    {"G", "giga", 9, false, ""},
+    {"M", "mega", 6, false, ""},
+    {"k", "kilo", 3, false, ""},
+    {"h", "hecto", 2, false, ""},
+    {"da", "deca", 1, false, ""},
+    {"d", "deci", -1, false, ""},
+    {"c", "centi", -2, false, ""},
+    {"m", "milli", -3, false, ""},
+    {"\xC2\xB5", "micro", -6, false, "u|\xCE\xBC"},    // µ (micro sign); u, μ (mu)
+    {"n", "nano", -9, false, ""},
+    {"p", "pico", -12, false, ""},
+    {"f", "femto", -15, false, ""},
+    {"a", "atto", -18, false, ""},
+    {"z", "zepto", -21, false, ""},
+    {"y", "yocto", -24, false, ""},
+    {"r", "ronto", -27, false, ""},
+    {"q", "quecto", -30, false, ""},
+    {"Ki", "kibi", 1, true, ""},
+    {"Mi", "mebi", 2, true, ""},
+    {"Gi", "gibi", 3, true, ""},
+    {"Ti", "tebi", 4, true, ""},
+    {"Pi", "pebi", 5, true, ""},
+    {"Ei", "exbi", 6, true, ""},
+    {"Zi", "zebi", 7, true, ""},
+    {"Yi", "yobi", 8, true, ""},
+};
+static_assert(std::size(Prefixes) == 32);
+
+// Masks over Prefixes, bit i for Prefixes[i]
+constexpr std::uint32_t NoPrefix = 0;
+constexpr std::uint32_t Si = 0x00FFFFFFu;
+constexpr std::uint32_t SiLarge = 0x000003FFu;      // kilo and up
+constexpr std::uint32_t Binary = 0xFF000000u;
+constexpr std::uint32_t KiloMegaGiga = 0x00000380u;
+
+/* ===================== BASE UNITS ===================== */
+
+// '%' marks where a prefix goes in symbols, names and aliases; without
+// one it goes in front. Aliases are '|'-separated; spelled-out aliases
+// are lower case (lookups of names fall back to lower case).
+struct BaseUnit {
+    const char *symbol;
+    const char *name;
+    Kind kind;
+    double scale;               // in the kind's SI unit
+    double offset;
+    std::uint32_t prefixes;
+    int power;                  // a prefix scales this power of the unit (m2: 2)
+    const char *symbolAliases;
+    const char *nameAliases;
+};
+
+constexpr double Pi = std::numbers::pi;
+
+// Earlier entries win name clashes, and unprefixed units are indexed
+// before any prefixed form
+constexpr BaseUnit BaseUnits[] = {
+    // Length (metre)
+    {"m", "metre", Kind::Length, 1.0, 0.0, Si, 1, "", "meter"},
+    {"in", "inch", Kind::Length, 0.0254, 0.0, NoPrefix, 1, "", "inches"},
+    {"ft", "foot", Kind::Length, 0.3048, 0.0, NoPrefix, 1, "", "feet"},
+    {"yd", "yard", Kind::Length, 0.9144, 0.0, NoPrefix, 1, "", ""},
+    {"mi", "mile", Kind::Length, 1609.344, 0.0, NoPrefix, 1, "", "statute mile"},
+    {"nmi", "nautical mile", Kind::Length, 1852.0, 0.0, NoPrefix, 1, "NM", ""},
+    {"mil", "thou", Kind::Length, 2.54e-5, 0.0, NoPrefix, 1, "", "mil"},
+    {"hh", "hand", Kind::Length, 0.1016, 0.0, NoPrefix, 1, "", ""},
+    {"ch", "chain", Kind::Length, 20.1168, 0.0, NoPrefix, 1, "", ""},
+    {"fur", "furlong", Kind::Length, 201.168, 0.0, NoPrefix, 1, "", ""},
+    {"ftm", "fathom", Kind::Length, 1.8288, 0.0, NoPrefix, 1, "", ""},
+    {"rd", "rod", Kind::Length, 5.0292, 0.0, NoPrefix, 1, "", ""},
+    {"lea", "league", Kind::Length, 4828.032, 0.0, NoPrefix, 1, "", ""},
+    {"\xC3\x85", "\xC3\xA5ngstr\xC3\xB6m", Kind::Length, 1e-10, 0.0, NoPrefix, 1, "", "angstrom"},   // Å, ångström
+    {"au", "astronomical unit", Kind::Length, 149597870700.0, 0.0, NoPrefix, 1, "AU|ua", ""},
+    {"ly", "light-year", Kind::Length, 9460730472580800.0, 0.0, NoPrefix, 1, "", "light year|lightyear"},
+    {"pc", "parsec", Kind::Length, 3.0856775814913673e16, 0.0, Si, 1, "", ""},
+
+    // Mass (kilogram; the gram carries the prefixes)
+    {"g", "gram", Kind::Mass, 1e-3, 0.0, Si, 1, "", "gramme"},
+    {"t", "tonne", Kind::Mass, 1000.0, 0.0, KiloMegaGiga, 1, "", "metric ton"},
+    {"lb", "pound", Kind::Mass, 0.45359237, 0.0, NoPrefix, 1, "lbs|lbm", "pound-mass"},
+    {"oz", "ounce", Kind::Mass, 0.028349523125, 0.0, NoPrefix, 1, "", ""},
+    {"st", "stone", Kind::Mass, 6.35029318, 0.0, NoPrefix, 1, "", ""},
+    {"gr", "grain", Kind::Mass, 6.479891e-5, 0.0, NoPrefix, 1, "", ""},
+    {"dr", "dram", Kind::Mass, 1.7718451953125e-3, 0.0, NoPrefix, 1, "", ""},
+    {"ozt", "troy ounce", Kind::Mass, 0.0311034768, 0.0, NoPrefix, 1, "", ""},
+    {"dwt", "pennyweight", Kind::Mass, 1.55517384e-3, 0.0, NoPrefix, 1, "", ""},
+    {"cwt", "hundredweight", Kind::Mass, 45.359237, 0.0, NoPrefix, 1, "", "short hundredweight"},
+    {"ton", "short ton", Kind::Mass, 907.18474, 0.0, NoPrefix, 1, "", "ton"},
+    {"LT", "long ton", Kind::Mass, 1016.0469088, 0.0, NoPrefix, 1, "", "imperial ton"},
+    {"ct", "carat", Kind::Mass, 2e-4, 0.0, NoPrefix, 1, "", ""},
+    {"slug", "slug", Kind::Mass, 14.59390294, 0.0, NoPrefix, 1, "", ""},
+    {"Da", "dalton", Kind::Mass, 1.66053906660e-27, 0.0, Si, 1, "u|amu", "atomic mass unit"},
+
+    // Time (second)
+    {"s", "second", Kind::Time, 1.0, 0.0, Si, 1, "sec", ""},
+    {"min", "minute", Kind::Time, 60.0, 0.0, NoPrefix, 1, "", ""},
+    {"h", "hour", Kind::Time, 3600.0, 0.0, NoPrefix, 1, "hr", ""},
+    {"d", "day", Kind::Time, 86400.0, 0.0, NoPrefix, 1, "", ""},
+    {"wk", "week", Kind::Time, 604800.0, 0.0, NoPrefix, 1, "", ""},
+    {"fortnight", "fortnight", Kind::Time, 1209600.0, 0.0, NoPrefix, 1, "", ""},
+    {"mo", "month", Kind::Time, 2629746.0, 0.0, NoPrefix, 1, "", ""},
+    {"a", "year", Kind::Time, 31557600.0, 0.0, KiloMegaGiga, 1, "yr", "julian year"},
+
+    // Temperature (kelvin)
+    {"K", "kelvin", Kind::Temperature, 1.0, 0.0, Si, 1, "", ""},
+    {"\xC2\xB0" "C", "degree Celsius", Kind::Temperature, 1.0, 273.15, NoPrefix, 1,
+     "degC|\xE2\x84\x83", "celsius|degree celsius|degrees celsius"},
+    {"\xC2\xB0" "F", "degree Fahrenheit", Kind::Temperature, 5.0 / 9.0, 459.67 * 5.0 / 9.0, NoPrefix, 1,
+     "degF|\xE2\x84\x89", "fahrenheit|degree fahrenheit|degrees fahrenheit"},
+    {"\xC2\xB0" "R", "degree Rankine", Kind::Temperature, 5.0 / 9.0, 0.0, NoPrefix, 1,
+     "degR", "rankine|degree rankine|degrees rankine"},
+
+    // Area (square metre)
+    {"%m2", "square %metre", Kind::Area, 1.0, 0.0, Si, 2, "%m\xC2\xB2|sq %m", "square %meter"},
+    {"ha", "hectare", Kind::Area, 1e4, 0.0, NoPrefix, 1, "", ""},
+    {"ar", "are", Kind::Area, 100.0, 0.0, NoPrefix, 1, "", ""},
+    {"ac", "acre", Kind::Area, 4046.8564224, 0.0, NoPrefix, 1, "", ""},
+    {"ft2", "square foot", Kind::Area, 0.09290304, 0.0, NoPrefix, 1, "ft\xC2\xB2|sq ft", "square feet"},
+    {"in2", "square inch", Kind::Area, 6.4516e-4, 0.0, NoPrefix, 1, "in\xC2\xB2|sq in", "square inches"},
+    {"yd2", "square yard", Kind::Area, 0.83612736, 0.0, NoPrefix, 1, "yd\xC2\xB2|sq yd", ""},
+    {"mi2", "square mile", Kind::Area, 2589988.110336, 0.0, NoPrefix, 1, "mi\xC2\xB2|sq mi", ""},
+
+    // Volume (cubic metre)
+    {"%m3", "cubic %metre", Kind::Volume, 1.0, 0.0, Si, 3, "%m\xC2\xB3", "cubic %meter"},
+    {"L", "litre", Kind::Volume, 1e-3, 0.0, Si, 1, "l", "liter"},
+    {"gal", "gallon", Kind::Volume, 3.785411784e-3, 0.0, NoPrefix, 1, "", "us gallon"},
+    {"imp gal", "imperial gallon", Kind::Volume, 4.54609e-3, 0.0, NoPrefix, 1, "", ""},
+    {"qt", "quart", Kind::Volume, 9.46352946e-4, 0.0, NoPrefix, 1, "", ""},
+    {"pt", "pint", Kind::Volume, 4.73176473e-4, 0.0, NoPrefix, 1, "", ""},
+    {"cup", "cup", Kind::Volume, 2.365882365e-4, 0.0, NoPrefix, 1, "", ""},
+    {"fl oz", "fluid ounce", Kind::Volume, 2.95735295625e-5, 0.0, NoPrefix, 1, "floz", ""},
+    {"tbsp", "tablespoon", Kind::Volume, 1.478676478125e-5, 0.0, NoPrefix, 1, "", ""},
+    {"tsp", "teaspoon", Kind::Volume, 4.92892159375e-6, 0.0, NoPrefix, 1, "", ""},
+    {"bbl", "barrel", Kind::Volume, 0.158987294928, 0.0, NoPrefix, 1, "", "oil barrel"},
+    {"ft3", "cubic foot", Kind::Volume, 0.028316846592, 0.0, NoPrefix, 1, "ft\xC2\xB3|cu ft", "cubic feet"},
+    {"in3", "cubic inch", Kind::Volume, 1.6387064e-5, 0.0, NoPrefix, 1, "in\xC2\xB3|cu in", "cubic inches"},
+    {"yd3", "cubic yard", Kind::Volume, 0.764554857984, 0.0, NoPrefix, 1, "yd\xC2\xB3|cu yd", ""},
+    {"ac ft", "acre-foot", Kind::Volume, 1233.48183754752, 0.0, NoPrefix, 1, "", "acre-feet|acre foot"},
+
+    // Speed (metre per second)
+    {"%m/s", "%metre per second", Kind::Speed, 1.0, 0.0, Si, 1, "",
+     "%meter per second|%metres per second|%meters per second"},
+    {"km/h", "kilometre per hour", Kind::Speed, 1.0 / 3.6, 0.0, NoPrefix, 1, "kph|kmh|km/hr",
+     "kilometer per hour|kilometres per hour|kilometers per hour"},
+    {"mph", "mile per hour", Kind::Speed, 0.44704, 0.0, NoPrefix, 1, "mi/h", "miles per hour"},
+    {"kn", "knot", Kind::Speed, 1852.0 / 3600.0, 0.0, NoPrefix, 1, "", ""},
+    {"ft/s", "foot per second", Kind::Speed, 0.3048, 0.0, NoPrefix, 1, "fps", "feet per second"},
+    {"c", "speed of light", Kind::Speed, 299792458.0, 0.0, NoPrefix, 1, "", ""},
+
+    // Acceleration (metre per second squared)
+    {"%m/s2", "%metre per second squared", Kind::Acceleration, 1.0, 0.0, Si, 1, "%m/s\xC2\xB2",
+     "%meter per second squared|%metres per second squared|%meters per second squared"},
+    {"Gal", "galileo", Kind::Acceleration, 0.01, 0.0, Si, 1, "", ""},
+    {"g0", "standard gravity", Kind::Acceleration, 9.80665, 0.0, NoPrefix, 1, "gn", ""},
+
+    // Force (newton)
+    {"N", "newton", Kind::Force, 1.0, 0.0, Si, 1, "", ""},
+    {"dyn", "dyne", Kind::Force, 1e-5, 0.0, NoPrefix, 1, "", ""},
+    {"lbf", "pound-force", Kind::Force, 4.4482216152605, 0.0, NoPrefix, 1, "", "pound force"},
+    {"kgf", "kilogram-force", Kind::Force, 9.80665, 0.0, NoPrefix, 1, "kp", "kilogram force|kilopond"},
+    {"pdl", "poundal", Kind::Force, 0.138254954376, 0.0, NoPrefix, 1, "", ""},
+
+    // Pressure (pascal)
+    {"Pa", "pascal", Kind::Pressure, 1.0, 0.0, Si, 1, "", ""},
+    {"bar", "bar", Kind::Pressure, 1e5, 0.0, Si, 1, "", ""},
+    {"atm", "atmosphere", Kind::Pressure, 101325.0, 0.0, NoPrefix, 1, "", ""},
+    {"at", "technical atmosphere", Kind::Pressure, 98066.5, 0.0, NoPrefix, 1, "", ""},
+    {"Torr", "torr", Kind::Pressure, 101325.0 / 760.0, 0.0, Si, 1, "", ""},
+    {"mmHg", "millimetre of mercury", Kind::Pressure, 133.322387415, 0.0, NoPrefix, 1, "",
+     "millimeter of mercury|millimetres of mercury|millimeters of mercury"},
+    {"inHg", "inch of mercury", Kind::Pressure, 3386.389, 0.0, NoPrefix, 1, "", "inches of mercury"},
+    {"psi", "pound per square inch", Kind::Pressure, 6894.757293168361, 0.0, NoPrefix, 1, "lbf/in2",
+     "pounds per square inch"},
+
+    // Energy (joule)
+    {"J", "joule", Kind::Energy, 1.0, 0.0, Si, 1, "", ""},
+    {"cal", "calorie", Kind::Energy, 4.184, 0.0, Si, 1, "", ""},
+    {"Wh", "watt-hour", Kind::Energy, 3600.0, 0.0, Si, 1, "", "watt hour"},
+    {"eV", "electronvolt", Kind::Energy, 1.602176634e-19, 0.0, Si, 1, "", "electron volt"},
+    {"BTU", "British thermal unit", Kind::Energy, 1055.05585262, 0.0, NoPrefix, 1, "Btu", "british thermal unit"},
+    {"erg", "erg", Kind::Energy, 1e-7, 0.0, NoPrefix, 1, "", ""},
+    {"thm", "therm", Kind::Energy, 105505585.262, 0.0, NoPrefix, 1, "", ""},
+    {"ft lbf", "foot-pound", Kind::Energy, 1.3558179483314004, 0.0, NoPrefix, 1, "ft-lbf|ft\xC2\xB7lbf",
+     "foot-pound force|foot pound"},
+    {"tTNT", "ton of TNT", Kind::Energy, 4.184e9, 0.0, NoPrefix, 1, "", "ton of tnt|tons of tnt"},
+
+    // Power (watt)
+    {"W", "watt", Kind::Power, 1.0, 0.0, Si, 1, "", ""},
+    {"hp", "horsepower", Kind::Power, 745.69987158227022, 0.0, NoPrefix, 1, "", "mechanical horsepower"},
+    {"PS", "metric horsepower", Kind::Power, 735.49875, 0.0, NoPrefix, 1, "", ""},
+    {"BTU/h", "BTU per hour", Kind::Power, 0.29307107017, 0.0, NoPrefix, 1, "Btu/h", "btu per hour"},
+    {"erg/s", "erg per second", Kind::Power, 1e-7, 0.0, NoPrefix, 1, "", ""},
+
+    // Frequency (hertz)
+    {"Hz", "hertz", Kind::Frequency, 1.0, 0.0, Si, 1, "", ""},
+    {"rpm", "revolution per minute", Kind::Frequency, 1.0 / 60.0, 0.0, NoPrefix, 1, "r/min",
+     "revolutions per minute"},
+
+    // Electromagnetism
+    {"A", "ampere", Kind::Current, 1.0, 0.0, Si, 1, "", "amp"},
+    {"C", "coulomb", Kind::Charge, 1.0, 0.0, Si, 1, "", ""},
+    {"Ah", "ampere-hour", Kind::Charge, 3600.0, 0.0, Si, 1, "", "ampere hour|amp-hour"},
+    {"V", "volt", Kind::Voltage, 1.0, 0.0, Si, 1, "", ""},
+    {"\xCE\xA9", "ohm", Kind::Resistance, 1.0, 0.0, Si, 1, "ohm|\xE2\x84\xA6", ""},  // Ω (omega), Ω (ohm sign)
+    {"S", "siemens", Kind::Conductance, 1.0, 0.0, Si, 1, "", ""},
+    {"F", "farad", Kind::Capacitance, 1.0, 0.0, Si, 1, "", ""},
+    {"H", "henry", Kind::Inductance, 1.0, 0.0, Si, 1, "", "henries"},
+    {"Wb", "weber", Kind::MagneticFlux, 1.0, 0.0, Si, 1, "", ""},
+    {"Mx", "maxwell", Kind::MagneticFlux, 1e-8, 0.0, NoPrefix, 1, "", ""},
+    {"T", "tesla", Kind::FluxDensity, 1.0, 0.0, Si, 1, "", ""},
+    {"G", "gauss", Kind::FluxDensity, 1e-4, 0.0, Si, 1, "", ""},
+
+    // Amount, light
+    {"mol", "mole", Kind::Amount, 1.0, 0.0, Si, 1, "", ""},
+    {"cd", "candela", Kind::LuminousIntensity, 1.0, 0.0, Si, 1, "", ""},
+    {"lm", "lumen", Kind::LuminousFlux, 1.0, 0.0, Si, 1, "", ""},
+    {"lx", "lux", Kind::Illuminance, 1.0, 0.0, Si, 1, "", ""},
+    {"fc", "foot-candle", Kind::Illuminance, 10.763910416709722, 0.0, NoPrefix, 1, "", "footcandle"},
+
+    // Angle (radian)
+    {"rad", "radian", Kind::Angle, 1.0, 0.0, Si, 1, "", ""},
+    {"\xC2\xB0", "degree", Kind::Angle, Pi / 180.0, 0.0, NoPrefix, 1, "deg", ""},
+    {"arcmin", "arcminute", Kind::Angle, Pi / 10800.0, 0.0, NoPrefix, 1, "\xE2\x80\xB2", ""},   // ′
+    {"arcsec", "arcsecond", Kind::Angle, Pi / 648000.0, 0.0, NoPrefix, 1, "\xE2\x80\xB3", ""},  // ″
+    {"gon", "gradian", Kind::Angle, Pi / 200.0, 0.0, NoPrefix, 1, "grad", "gon"},
+    {"tr", "turn", Kind::Angle, 2.0 * Pi, 0.0, NoPrefix, 1, "rev", "revolution"},
+    {"sr", "steradian", Kind::SolidAngle, 1.0, 0.0, Si, 1, "", ""},
+
+    // Information (bit)
+    {"bit", "bit", Kind::Information, 1.0, 0.0, SiLarge | Binary, 1, "", ""},
+    {"B", "byte", Kind::Information, 8.0, 0.0, SiLarge | Binary, 1, "", "octet"},
+    {"bit/s", "bit per second", Kind::DataRate, 1.0, 0.0, SiLarge | Binary, 1, "bps", "bits per second"},
+    {"B/s", "byte per second", Kind::DataRate, 8.0, 0.0, SiLarge | Binary, 1, "Bps", "bytes per second"},
+
+    // Radiation, catalysis
+    {"Bq", "becquerel", Kind::Radioactivity, 1.0, 0.0, Si, 1, "", ""},
+    {"Ci", "curie", Kind::Radioactivity, 3.7e10, 0.0, Si, 1, "", ""},
+    {"Gy", "gray", Kind::AbsorbedDose, 1.0, 0.0, Si, 1, "", ""},
+    {"Sv", "sievert", Kind::EquivalentDose, 1.0, 0.0, Si, 1, "", ""},
+    {"rem", "rem", Kind::EquivalentDose, 0.01, 0.0, Si, 1, "", ""},
+    {"kat", "katal", Kind::CatalyticActivity, 1.0, 0.0, Si, 1, "", ""},
+};
+
+constexpr const char *KindNames[] = {
+    "length", "mass", "time", "temperature", "area", "volume", "speed", "acceleration",
+    "force", "pressure", "energy", "power", "frequency", "electric current", "electric charge", "voltage",
+    "resistance", "conductance", "capacitance", "inductance", "magnetic flux",
+    "magnetic flux density", "amount of substance", "luminous intensity", "luminous flux", "illuminance",
+    "angle", "solid angle", "information", "data rate", "radioactivity", "absorbed dose",
+    "equivalent dose", "catalytic activity",
+};
+static_assert(std::size(KindNames) == static_cast<std::size_t>(Kind::CatalyticActivity) + 1);
+
+/* ===================== HELPERS ===================== */
+
+std::uint32_t hashName(std::string_view s) {
+    // FNV-1a; names are short
+    std::uint32_t h = 2166136261u;
+    for (char c : s) {
+        h ^= static_cast<unsigned char>(c);
+        h *= 16777619u;
+    }
+    return h;
+}
+
+double prefixScale(const Prefix &p, int power) {
+    const int exponent = p.exponent * power;
+    if (p.binary) return std::ldexp(1.0, 10 * exponent);
+    // Divide for negative exponents: 1 / 1e3 rounds correctly, 1e-3 does not multiply exactly
+    return exponent >= 0 ? std::pow(10.0, exponent) : 1.0 / std::pow(10.0, -exponent);
+}
+
+// Calls fn for each '|'-separated part
+template <class Fn>
+void forEachAlias(std::string_view list, Fn fn) {
+    while (!list.empty()) {
+        const std::size_t bar = list.find('|');
+        fn(list.substr(0, bar));
+        if (bar == std::string_view::npos) break;
+        list.remove_prefix(bar + 1);
+    }
+}
+
+} // namespace
+
+/* ===================== BUILD ===================== */
+
+UnitCatalog::UnitCatalog() {
+    std::size_t unitCount = 0;
+    for (const BaseUnit &u : BaseUnits)
+        unitCount += 1 + static_cast<std::size_t>(std::popcount(u.prefixes));
+
+    records.reserve(unitCount);
+    arena.reserve(unitCount * 40);
+
+    // Names in priority order; indexed once the count is known
+    std::vector<Slot> pending;
+    pending.reserve(unitCount * 5);
+
+    auto addText = [&](std::string_view pattern, std::string_view prefix) {
+        const std::size_t mark = pattern.find('%');
+        const std::uint32_t offset = static_cast<std::uint32_t>(arena.size());
+        if (mark == std::string_view::npos) {
+            arena.insert(arena.end(), prefix.begin(), prefix.end());
+            arena.insert(arena.end(), pattern.begin(), pattern.end());
+        } else {
+            arena.insert(arena.end(), pattern.begin(), pattern.begin() + mark);
+            arena.insert(arena.end(), prefix.begin(), prefix.end());
+            arena.insert(arena.end(), pattern.begin() + mark + 1, pattern.end());
+        }
+        return offset;
+    };
+    auto addAlias = [&](std::string_view pattern, std::string_view prefix, CatalogId unit, bool isName) {
+        const std::uint32_t offset = addText(pattern, prefix);
+        pending.push_back({offset, unit, static_cast<std::uint8_t>(arena.size() - offset),
+                           static_cast<std::uint8_t>(isName)});
+    };
+    auto addUnit = [&](const BaseUnit &u, const Prefix *p) {
+        const CatalogId id = static_cast<CatalogId>(records.size());
+        const std::string_view symbolPrefix = p ? p->symbol : "";
+        const std::string_view namePrefix = p ? p->name : "";
+
+        Record r{};
+        r.scale = p ? u.scale * prefixScale(*p, u.power) : u.scale;
+        r.kind = u.kind;
+        if (u.offset != 0.0) {
+            r.offsetIndex = static_cast<std::uint8_t>(offsets.size());
+            offsets.push_back(u.offset);
+        }
+        r.text = addText(u.symbol, symbolPrefix);
+        r.symbolLength = static_cast<std::uint8_t>(arena.size() - r.text);
+        addText(u.name, namePrefix);
+        r.nameLength = static_cast<std::uint8_t>(arena.size() - r.text - r.symbolLength);
+        records.push_back(r);
+
+        pending.push_back({r.text, id, r.symbolLength, 0});
+        pending.push_back({r.text + r.symbolLength, id, r.nameLength, 1});
+        forEachAlias(u.symbolAliases, [&](std::string_view a) { addAlias(a, symbolPrefix, id, false); });
+        if (p) {
+            forEachAlias(p->symbolAliases, [&](std::string_view ps) {
+                addAlias(u.symbol, ps, id, false);
+                forEachAlias(u.symbolAliases, [&](std::string_view a) { addAlias(a, ps, id, false); });
+            });
+        }
+        forEachAlias(u.nameAliases, [&](std::string_view a) { addAlias(a, namePrefix, id, true); });
+    };
+
+    for (const BaseUnit &u : BaseUnits)
+        addUnit(u, nullptr);
+    for (const BaseUnit &u : BaseUnits) {
+        for (std::uint32_t bits = u.prefixes; bits; bits &= bits - 1)
+            addUnit(u, &Prefixes[std::countr_zero(bits)]);
+    }
+    arena.shrink_to_fit();
+
+    // Open addressing with linear probing, at most ~80% full
+    slots.assign(std::bit_ceil(pending.size() + pending.size() / 4 + 1), Slot{});
+    for (const Slot &s : pending)
+        addName(s.text, s.length, s.unit, s.isName);
+}
+
+void UnitCatalog::addName(std::uint32_t text, std::size_t length, CatalogId unit, bool isName) {
+    const std::string_view name(arena.data() + text, length);
+    const std::size_t mask = slots.size() - 1;
+    for (std::size_t i = hashName(name) & mask;; i = (i + 1) & mask) {
+        Slot &slot = slots[i];
+        if (slot.unit == InvalidCatalogId) {
+            slot = {text, unit, static_cast<std::uint8_t>(length), static_cast<std::uint8_t>(isName)};
+            ++names;
+            return;
+        }
+        if (slot.length == length && std::memcmp(arena.data() + slot.text, name.data(), length) == 0) {
+            // Taken: the first unit keeps it; a symbol that is also the
+            // unit's name ("bar") then matches as a name too
+            if (slot.unit == unit && isName) slot.isName = 1;
+            return;
+        }
+    }
+}
+
+const UnitCatalog &UnitCatalog::builtin() {
+    static const UnitCatalog catalog;
+    return catalog;
+}
+
+const char *UnitCatalog::kindName(Kind kind) {
+    return KindNames[static_cast<std::size_t>(kind)];
+}
+
+/* ===================== LOOKUP ===================== */
+
+const UnitCatalog::Slot *UnitCatalog::lookup(std::string_view name) const {
+    const std::size_t mask = slots.size() - 1;
+    for (std::size_t i = hashName(name) & mask;; i = (i + 1) & mask) {
+        const Slot &slot = slots[i];
+        if (slot.unit == InvalidCatalogId) return nullptr;
+        if (slot.length == name.size() && std::memcmp(arena.data() + slot.text, name.data(), name.size()) == 0)
+            return &slot;
+    }
+}
+
+CatalogId UnitCatalog::find(std::string_view name) const {
+    if (name.empty() || name.size() > 255) return InvalidCatalogId;
+    if (const Slot *s = lookup(name)) return s->unit;
+
+    // Spelled-out names only: regular plurals and capitals ("Kilometres")
+    char lower[255];
+    bool folded = false;
+    for (std::size_t i = 0; i < name.size(); ++i) {
+        const char c = name[i];
+        lower[i] = (c >= 'A' && c <= 'Z') ? static_cast<char>(c + ('a' - 'A')) : c;
+        folded |= lower[i] != c;
+    }
+    const std::string_view lowered(lower, name.size());
+    if (folded) {
+        if (const Slot *s = lookup(lowered); s && s->isName) return s->unit;
+    }
+    if (lowered.size() > 3 && lowered.back() == 's') {
+        if (const Slot *s = lookup(lowered.substr(0, lowered.size() - 1)); s && s->isName) return s->unit;
+    }
+    return InvalidCatalogId;
+}
+
+CatalogId UnitCatalog::find(QStringView name) const {
+    // On the stack; a name too long for it is longer than any stored one
+    char utf8[255];
+    const Utf8::Encoded e = Utf8::encode(name, utf8, sizeof(utf8));
+    return e.complete ? find(std::string_view(utf8, e.size)) : InvalidCatalogId;
+}
+
+std::string_view UnitCatalog::symbol(CatalogId id) const {
+    const Record &r = records[id];
+    return std::string_view(arena.data() + r.text, r.symbolLength);
+}
+
+std::string_view UnitCatalog::name(CatalogId id) const {
+    const Record &r = records[id];
+    return std::string_view(arena.data() + r.text + r.symbolLength, r.nameLength);
+}
+
+/* ===================== CONVERSION ===================== */
+
+ConversionPlan UnitCatalog::plan(CatalogId from, CatalogId to) const {
+    if (!isValid(from) || !isValid(to) || kind(from) != kind(to))
+        return ConversionPlan::invalid();
+
+    // dst = (src * from.scale + from.offset - to.offset) / to.scale
+    const double s = scale(from) / scale(to);
+    return ConversionPlan::affine(s, (offset(from) - offset(to)) / scale(to));
+}
+
+ConversionPlan UnitCatalog::plan(QStringView from, QStringView to) const {
+    return plan(find(from), find(to));
+}
+
+std::size_t UnitCatalog::memoryBytes() const {
+    return arena.capacity() + records.capacity() * sizeof(Record)
+         + offsets.capacity() * sizeof(double) + slots.capacity() * sizeof(Slot);
+}
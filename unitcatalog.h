@@ -0,0 +1,102 @@
+#ifndef UNITCATALOG_H
+#define UNITCATALOG_H
+
+#include <QStringView>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+#include "conversionplan.h"
+
+// Index of a unit in a UnitCatalog
+using CatalogId = std::uint16_t;
+inline constexpr CatalogId InvalidCatalogId = 0xFFFF;
+
+// The unit catalogue: about 140 base units across 34 kinds of quantity,
+// every SI (and, for data, binary) prefixed form of the prefixable ones,
+// and their spelled-out names and common aliases; 1,297 units under
+// 3,594 names in all. That is the SI and common customary set, not all of
+// UCUM: its clinical, arbitrary and compound units are not included.
+// Nothing here limits the size short of 65,535 units (CatalogId).
+//
+// Storage is compact and built in one pass at load: all names live in one
+// string arena, each unit is a 16-byte record indexed by CatalogId, and
+// names and aliases resolve through one open-addressing hash table.
+// Symbols are case-sensitive ("mm" is not "Mm"); spelled-out names also
+// match capitalised and with a regular plural "s" ("Kilometres").
+//
+// The catalogue is immutable once built and safe to share between
+// threads. It complements the Units symbol table, which keeps the GUI's
+// units and their factors; Units falls back to builtin() for names it
+// does not know.
+class UnitCatalog
+{
+public:
+    enum class Kind : std::uint8_t {
+        Length, Mass, Time, Temperature, Area, Volume, Speed, Acceleration,
+        Force, Pressure, Energy, Power, Frequency, Current, Charge, Voltage,
+        Resistance, Conductance, Capacitance, Inductance, MagneticFlux,
+        FluxDensity, Amount, LuminousIntensity, LuminousFlux, Illuminance,
+        Angle, SolidAngle, Information, DataRate, Radioactivity, AbsorbedDose,
+        EquivalentDose, CatalyticActivity,
+    };
+
+    // Builds the catalogue; prefer the shared builtin() instance
+    UnitCatalog();
+
+    static const UnitCatalog &builtin();
+    static const char *kindName(Kind kind);
+
+    // UTF-8 names; no allocation
+    CatalogId find(std::string_view name) const;
+    CatalogId find(QStringView name) const;
+
+    std::size_t size() const { return records.size(); }
+    bool isValid(CatalogId id) const { return id < records.size(); }
+
+    std::string_view symbol(CatalogId id) const;
+    std::string_view name(CatalogId id) const;
+    Kind kind(CatalogId id) const { return records[id].kind; }
+
+    // The unit in its kind's SI unit: si = value * scale + offset
+    double scale(CatalogId id) const { return records[id].scale; }
+    double offset(CatalogId id) const { return offsets[records[id].offsetIndex]; }
+
+    // Invalid for unknown units or different kinds
+    ConversionPlan plan(CatalogId from, CatalogId to) const;
+    ConversionPlan plan(QStringView from, QStringView to) const;
+
+    std::size_t nameCount() const { return names; }
+    std::size_t memoryBytes() const;
+
+private:
+    struct Record {
+        double scale;
+        std::uint32_t text;             // arena: symbol, then name
+        std::uint8_t symbolLength;
+        std::uint8_t nameLength;
+        Kind kind;
+        std::uint8_t offsetIndex;       // into offsets; 0 is no offset
+    };
+    static_assert(sizeof(Record) == 16);
+
+    struct Slot {
+        std::uint32_t text;
+        CatalogId unit = InvalidCatalogId;  // InvalidCatalogId: empty
+        std::uint8_t length;
+        std::uint8_t isName;                // spelled out, not a symbol
+    };
+    static_assert(sizeof(Slot) == 8);
+
+    std::uint32_t append(std::string_view text);
+    void addName(std::uint32_t text, std::size_t length, CatalogId unit, bool isName);
+    const Slot *lookup(std::string_view name) const;
+
+    std::vector<char> arena;
+    std::vector<Record> records;
+    std::vector<double> offsets{0.0};
+    std::vector<Slot> slots;            // power-of-two size
+    std::size_t names = 0;
+};
+
+#endif // UNITCATALOG_H
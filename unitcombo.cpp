@@ -0,0 +1,242 @@
+#include "unitcombo.h"
+
+#include <QCompleter>
+#include <QCoreApplication>
+#include <QLineEdit>
+#include <QListView>
+#include <array>
+
+#include "trace.h"
+#include "unitcatalog.h"
+#include "unitnames.h"
+
+namespace {
+
+// Rows a completer popup shows at most
+constexpr std::size_t MaxMatches = 50;
+
+constexpr std::size_t CategoryCount = static_cast<std::size_t>(UnitCategory::Currency) + 1;
+
+// Catalogue kind offered in a tab; currencies are not in the catalogue
+bool catalogKind(UnitCategory category, UnitCatalog::Kind &kind) {
+    switch (category) {
+    case UnitCategory::Length:      kind = UnitCatalog::Kind::Length; return true;
+    case UnitCategory::Weight:      kind = UnitCatalog::Kind::Mass; return true;
+    case UnitCategory::Temperature: kind = UnitCatalog::Kind::Temperature; return true;
+    case UnitCategory::Volume:      kind = UnitCatalog::Kind::Volume; return true;
+    case UnitCategory::Speed:       kind = UnitCatalog::Kind::Speed; return true;
+    case UnitCategory::Currency:    break;
+    }
+    return false;
+}
+
+QString fromUtf8(std::string_view text) {
+    return QString::fromUtf8(text.data(), static_cast<qsizetype>(text.size()));
+}
+
+} // namespace
+
+void UnitCombo::populate(QComboBox *combo, UnitCategory category) {
+    if (!combo) return;
+
+    if (auto *picker = qobject_cast<UnitPicker *>(combo))
+        picker->setCategory(category);
+    else
+        combo->setModel(UnitListModel::forCategory(category));
+}
+
+/* ===================== SHARED UNIT MODEL ===================== */
+
+UnitListModel *UnitListModel::forCategory(UnitCategory category) {
+    static std::array<UnitListModel *, CategoryCount> models{};
+
+    UnitListModel *&model = models[static_cast<std::size_t>(category)];
+    if (!model) model = new UnitListModel(category, QCoreApplication::instance());
+    return model;
+}
+
+UnitListModel::UnitListModel(UnitCategory category, QObject *parent)
+    : QAbstractListModel(parent)
+{
+    TRACE_SCOPE_ARG("UnitListModel", category);
+    const Units &units = Units::getInstance();
+    const UnitCatalog &catalog = UnitCatalog::builtin();
+
+    for (const QString &name : units.displayUnits(category)) {
+        const UnitId id = units.unitId(name);
+        if (units.isValid(id)) rows.push_back({id, false});
+    }
+
+    UnitCatalog::Kind kind;
+    if (catalogKind(category, kind)) {
+        for (CatalogId id = 0; id < catalog.size(); ++id) {
+            if (catalog.kind(id) != kind) continue;
+            // The same unit as a built-in one ("km", "kilometre": Kilometers),
+            // offered above under that name; quantity.h and the catalogue
+            // use the same definitions, so hiding it loses nothing
+            if (units.unitId(catalog.symbol(id)) != InvalidUnitId
+                || units.unitId(catalog.name(id)) != InvalidUnitId) continue;
+            rows.push_back({id, true});
+        }
+    }
+
+    // Search keys: built-in names with their aliases, catalogue symbols and names
+    for (std::uint32_t r = 0; r < rows.size(); ++r) {
+        if (rows[r].catalog) {
+            search.add(r, catalog.symbol(rows[r].id));
+            search.add(r, catalog.name(rows[r].id));
+            continue;
+        }
+        const QByteArray name = units.unitName(rows[r].id).toUtf8();
+        const std::string_view canonical(name.constData(), static_cast<std::size_t>(name.size()));
+        search.add(r, canonical);
+        for (const UnitNames::Alias &alias : UnitNames::Aliases) {
+            if (alias.unit == canonical) search.add(r, alias.name);
+        }
+    }
+    search.build();
+}
+
+int UnitListModel::rowCount(const QModelIndex &parent) const {
+    return parent.isValid() ? 0 : static_cast<int>(rows.size());
+}
+
+QVariant UnitListModel::data(const QModelIndex &index, int role) const {
+    if (!index.isValid() || index.row() >= static_cast<int>(rows.size())) return QVariant();
+
+    switch (role) {
+    case Qt::DisplayRole:
+    case Qt::EditRole:
+        return label(index.row());
+    case UnitNameRole:
+        return unitName(index.row());
+    default:
+        return QVariant();
+    }
+}
+
+QString UnitListModel::label(int row) const {
+    const Row &r = rows[static_cast<std::size_t>(row)];
+    if (!r.catalog) return Units::getInstance().unitName(r.id);
+
+    const UnitCatalog &catalog = UnitCatalog::builtin();
+    return QString("%1 (%2)").arg(fromUtf8(catalog.name(r.id)), fromUtf8(catalog.symbol(r.id)));
+}
+
+QString UnitListModel::unitName(int row) const {
+    const Row &r = rows[static_cast<std::size_t>(row)];
+    // Catalogue names are unique; a few symbols are not ("PS")
+    return r.catalog ? fromUtf8(UnitCatalog::builtin().name(r.id)) : Units::getInstance().unitName(r.id);
+}
+
+int UnitListModel::rowOf(const QString &unitName) const {
+    Row wanted{Units::getInstance().unitId(unitName), false};
+    if (wanted.id == InvalidUnitId) wanted = {UnitCatalog::builtin().find(QStringView(unitName)), true};
+
+    for (std::size_t r = 0; r < rows.size(); ++r) {
+        if (rows[r].id == wanted.id && rows[r].catalog == wanted.catalog) return static_cast<int>(r);
+    }
+    return -1;
+}
+
+void UnitListModel::match(QStringView text, std::vector<UnitSearch::Match> &out, std::size_t limit) const {
+    search.search(text, out, limit);
+}
+
+/* ===================== PICKER ===================== */
+
+// Current matches, in rank order, as rows of the shared model
+class UnitPicker::MatchModel : public QAbstractListModel
+{
+public:
+    enum { RowRole = Qt::UserRole + 100 };
+
+    using QAbstractListModel::QAbstractListModel;
+
+    void setMatches(const UnitListModel *model, std::vector<UnitSearch::Match> &found) {
+        beginResetModel();
+        units = model;
+        matches.swap(found);
+        endResetModel();
+    }
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override {
+        return parent.isValid() ? 0 : static_cast<int>(matches.size());
+    }
+
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override {
+        if (!index.isValid() || index.row() >= static_cast<int>(matches.size())) return QVariant();
+        const int row = static_cast<int>(matches[static_cast<std::size_t>(index.row())].item);
+        if (role == RowRole) return row;
+        if (role == Qt::DisplayRole || role == Qt::EditRole) return units->label(row);
+        return QVariant();
+    }
+
+private:
+    const UnitListModel *units = nullptr;
+    std::vector<UnitSearch::Match> matches;
+};
+
+UnitPicker::UnitPicker(QWidget *parent)
+    : QComboBox(parent)
+{
+    setEditable(true);
+    setInsertPolicy(QComboBox::NoInsert);
+
+    // Width from a fixed length and uniform rows, so nothing measures
+    // every unit of a long list
+    setSizeAdjustPolicy(QComboBox::AdjustToMinimumContentsLengthWithIcon);
+    setMinimumContentsLength(18);
+    if (auto *list = qobject_cast<QListView *>(view())) list->setUniformItemSizes(true);
+
+    matches = new MatchModel(this);
+    completer = new QCompleter(matches, this);
+    completer->setCompletionMode(QCompleter::UnfilteredPopupCompletion);
+    completer->setMaxVisibleItems(10);
+    lineEdit()->setCompleter(completer);
+
+    // The line edit shows the popup itself once textEdited has run
+    connect(lineEdit(), &QLineEdit::textEdited, this, &UnitPicker::updateMatches);
+    connect(completer, qOverload<const QModelIndex &>(&QCompleter::activated), this,
+            [this](const QModelIndex &index) { setCurrentIndex(index.data(MatchModel::RowRole).toInt()); });
+    connect(lineEdit(), &QLineEdit::editingFinished, this, &UnitPicker::commitText);
+}
+
+void UnitPicker::setCategory(UnitCategory category) {
+    units = UnitListModel::forCategory(category);
+    setModel(units);
+    // QComboBox::setModel hands the full model to the completer too
+    completer->setModel(matches);
+}
+
+QString UnitPicker::currentUnit() const {
+    return units && currentIndex() >= 0 ? units->unitName(currentIndex()) : QString();
+}
+
+void UnitPicker::setCurrentUnit(const QString &unitName) {
+    if (!units) return;
+    const int row = units->rowOf(unitName);
+    if (row >= 0) setCurrentIndex(row);
+}
+
+void UnitPicker::updateMatches(const QString &text) {
+    if (!units) return;
+    TRACE_SCOPE("unitPicker.match");
+    std::vector<UnitSearch::Match> found;
+    units->match(text, found, MaxMatches);
+    matches->setMatches(units, found);
+}
+
+// Enter or focus out: take the best match for free text, or put the
+// current unit's label back when nothing matches
+void UnitPicker::commitText() {
+    if (!units || currentIndex() < 0) return;
+
+    const QString text = lineEdit()->text();
+    if (text == itemText(currentIndex())) return;
+
+    std::vector<UnitSearch::Match> found;
+    units->match(text, found, 1);
+    if (!found.empty()) setCurrentIndex(static_cast<int>(found.front().item));
+    lineEdit()->setText(itemText(currentIndex()));
+}
@@ -0,0 +1,91 @@
+#ifndef UNITCOMBO_H
+#define UNITCOMBO_H
+
+#include <QAbstractListModel>
+#include <QComboBox>
+#include <cstdint>
+#include <vector>
+
+#include "units.h"
+#include "unitsearch.h"
+
+class QCompleter;
+
+// Widgets adapter for the conversion core: keeps QtWidgets out of
+// converter_core so headless tools link QtCore only.
+namespace UnitCombo {
+
+// Points the combo at the shared unit model of `category`; no items are
+// copied, so repeating it is cheap
+void populate(QComboBox *combo, UnitCategory category);
+
+} // namespace UnitCombo
+
+// The units offered in one category: the tab's own units first, then the
+// UnitCatalog units of the same kind ("millimetre (mm)"). One instance per
+// category is shared by every combo box; labels are built on demand, so
+// views only touch the rows they draw.
+class UnitListModel : public QAbstractListModel
+{
+    Q_OBJECT
+
+public:
+    enum Role {
+        UnitNameRole = Qt::UserRole + 1,    // name Units::convert accepts
+    };
+
+    // Created on first use, owned by the application
+    static UnitListModel *forCategory(UnitCategory category);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+
+    QString label(int row) const;
+    QString unitName(int row) const;
+
+    // Row of a unit by the name data(UnitNameRole) gives, or -1
+    int rowOf(const QString &unitName) const;
+
+    // Ranked rows for typed text: names, symbols and aliases, with
+    // misspellings tolerated (see UnitSearch)
+    void match(QStringView text, std::vector<UnitSearch::Match> &out, std::size_t limit) const;
+
+private:
+    explicit UnitListModel(UnitCategory category, QObject *parent);
+
+    struct Row {
+        std::uint16_t id;       // UnitId, or CatalogId when `catalog`
+        bool catalog;
+    };
+
+    std::vector<Row> rows;
+    UnitSearch search;
+};
+
+// Editable unit combo box: typing shows the best matches from the shared
+// model in a completer popup, Enter takes the highlighted (by default the
+// best) match. The drop-down still lists every unit of the category.
+class UnitPicker : public QComboBox
+{
+    Q_OBJECT
+
+public:
+    explicit UnitPicker(QWidget *parent = nullptr);
+
+    void setCategory(UnitCategory category);
+
+    // Name for Units::convert; empty before setCategory
+    QString currentUnit() const;
+    void setCurrentUnit(const QString &unitName);
+
+private:
+    void updateMatches(const QString &text);
+    void commitText();
+
+    UnitListModel *units = nullptr;
+    QCompleter *completer = nullptr;
+    class MatchModel;
+    MatchModel *matches = nullptr;
+};
+
+#endif // UNITCOMBO_H
@@ -0,0 +1,241 @@
+#include "unitmetrics.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+
+std::atomic<bool> UnitMetrics::enabled{[]() {
+    const char *env = std::getenv("CONVERTER_METRICS");
+    return env && *env && *env != '0';
+}()};
+
+namespace {
+
+// Single-writer counter: only the owning thread increments, readers may
+// load concurrently. Avoids a locked read-modify-write on the hot path.
+struct Counter {
+    std::atomic<std::uint64_t> value{0};
+
+    void add(std::uint64_t n) { value.store(value.load(std::memory_order_relaxed) + n, std::memory_order_relaxed); }
+    std::uint64_t load() const { return value.load(std::memory_order_relaxed); }
+    void clear() { value.store(0, std::memory_order_relaxed); }
+};
+
+// Small open-addressed table of (from, to) -> count, written by one thread
+struct PairTable {
+    static constexpr std::size_t Slots = 256;
+    static constexpr std::size_t MaxProbe = 16;
+
+    std::array<std::atomic<std::uint32_t>, Slots> keys{};   // (from << 16 | to) + 1, 0 = empty
+    std::array<Counter, Slots> counts;
+    Counter overflow;
+
+    void add(std::uint16_t from, std::uint16_t to, std::uint64_t n) {
+        const std::uint32_t key = ((static_cast<std::uint32_t>(from) << 16) | to) + 1;
+        std::size_t slot = (key * 2654435761u) % Slots;
+        for (std::size_t probe = 0; probe < MaxProbe; ++probe, slot = (slot + 1) % Slots) {
+            std::uint32_t k = keys[slot].load(std::memory_order_relaxed);
+            if (k == 0) {
+                keys[slot].store(key, std::memory_order_release);
+                k = key;
+            }
+            if (k == key) {
+                counts[slot].add(n);
+                return;
+            }
+        }
+        overflow.add(n);
+    }
+};
+
+struct Shard {
+    std::array<Counter, UnitMetrics::CategoryCount> conversions;
+    std::array<Counter, UnitMetrics::CategoryCount> batchElements;
+    std::array<Counter, UnitMetrics::FallbackCount> fallbacks;
+    std::array<std::array<Counter, UnitMetrics::Histogram::BucketCount>, UnitMetrics::CategoryCount> latency;
+    PairTable pairs;
+    std::uint32_t sampleTick = 0;   // owner thread only
+};
+
+// Owns every shard ever handed out. Shards of exited threads are kept,
+// counts included, and recycled for new threads.
+struct Registry {
+    std::mutex mutex;
+    std::vector<std::unique_ptr<Shard>> shards;
+    std::vector<Shard *> idle;
+
+    Shard *acquire() {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!idle.empty()) {
+            Shard *s = idle.back();
+            idle.pop_back();
+            return s;
+        }
+        shards.push_back(std::make_unique<Shard>());
+        return shards.back().get();
+    }
+
+    void release(Shard *s) {
+        std::lock_guard<std::mutex> lock(mutex);
+        idle.push_back(s);
+    }
+};
+
+Registry &registry() {
+    static Registry *r = new Registry;  // outlives thread_local destructors at exit
+    return *r;
+}
+
+struct ShardHandle {
+    Shard *shard = registry().acquire();
+    ~ShardHandle() { registry().release(shard); }
+};
+
+Shard &localShard() {
+    thread_local ShardHandle handle;
+    return *handle.shard;
+}
+
+} // namespace
+
+/* ===================== HISTOGRAM ===================== */
+
+std::size_t UnitMetrics::Histogram::bucketFor(std::uint64_t ns) {
+    constexpr std::uint64_t subCount = std::uint64_t(1) << SubBucketBits;
+    if (ns < subCount)
+        return static_cast<std::size_t>(ns);
+
+    unsigned exponent = static_cast<unsigned>(std::bit_width(ns)) - 1;
+    if (exponent > MaxExponent)
+        return BucketCount - 1;
+
+    const unsigned shift = exponent - SubBucketBits;
+    const std::size_t sub = static_cast<std::size_t>((ns >> shift) & (subCount - 1));
+    return ((exponent - SubBucketBits + 1) << SubBucketBits) + sub;
+}
+
+std::uint64_t UnitMetrics::Histogram::bucketLowerBound(std::size_t bucket) {
+    constexpr std::size_t subCount = std::size_t(1) << SubBucketBits;
+    if (bucket < subCount)
+        return bucket;
+
+    const std::size_t exponent = (bucket >> SubBucketBits) + SubBucketBits - 1;
+    const std::size_t sub = bucket & (subCount - 1);
+    return (std::uint64_t(1) << exponent) + (static_cast<std::uint64_t>(sub) << (exponent - SubBucketBits));
+}
+
+std::uint64_t UnitMetrics::Histogram::count() const {
+    std::uint64_t total = 0;
+    for (std::uint64_t b : buckets) total += b;
+    return total;
+}
+
+std::uint64_t UnitMetrics::Histogram::percentile(double q) const {
+    const std::uint64_t total = count();
+    if (total == 0) return 0;
+
+    const std::uint64_t rank = static_cast<std::uint64_t>(std::clamp(q, 0.0, 1.0) * static_cast<double>(total - 1)) + 1;
+    std::uint64_t seen = 0;
+    for (std::size_t i = 0; i < BucketCount; ++i) {
+        seen += buckets[i];
+        if (seen >= rank) return bucketLowerBound(i);
+    }
+    return bucketLowerBound(BucketCount - 1);
+}
+
+/* ===================== RECORDING ===================== */
+
+void UnitMetrics::setEnabled(bool on) {
+    enabled.store(on, std::memory_order_relaxed);
+}
+
+bool UnitMetrics::shouldSample() {
+    Shard &s = localShard();
+    return ++s.sampleTick % SampleInterval == 0;
+}
+
+void UnitMetrics::recordConversion(std::size_t category, std::uint16_t from, std::uint16_t to) {
+    Shard &s = localShard();
+    s.conversions[category].add(1);
+    s.pairs.add(from, to, 1);
+}
+
+void UnitMetrics::recordBatch(std::size_t category, std::uint16_t from, std::uint16_t to, std::size_t elements) {
+    Shard &s = localShard();
+    s.conversions[category].add(1);
+    s.batchElements[category].add(elements);
+    s.pairs.add(from, to, 1);
+}
+
+void UnitMetrics::recordFallback(Fallback reason) {
+    localShard().fallbacks[static_cast<std::size_t>(reason)].add(1);
+}
+
+void UnitMetrics::recordLatency(std::size_t category, std::uint64_t ns) {
+    localShard().latency[category][Histogram::bucketFor(ns)].add(1);
+}
+
+/* ===================== AGGREGATION ===================== */
+
+UnitMetrics::Snapshot UnitMetrics::collect() {
+    Snapshot out;
+    std::vector<PairCount> pairs;
+
+    Registry &r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    for (const std::unique_ptr<Shard> &shard : r.shards) {
+        const Shard &s = *shard;
+        for (std::size_t c = 0; c < CategoryCount; ++c) {
+            out.conversions[c] += s.conversions[c].load();
+            out.batchElements[c] += s.batchElements[c].load();
+            for (std::size_t b = 0; b < Histogram::BucketCount; ++b)
+                out.latency[c].buckets[b] += s.latency[c][b].load();
+        }
+        for (std::size_t f = 0; f < FallbackCount; ++f)
+            out.fallbacks[f] += s.fallbacks[f].load();
+
+        for (std::size_t i = 0; i < PairTable::Slots; ++i) {
+            const std::uint32_t key = s.pairs.keys[i].load(std::memory_order_acquire);
+            if (key == 0 || s.pairs.counts[i].load() == 0) continue;
+            pairs.push_back({static_cast<std::uint16_t>((key - 1) >> 16),
+                             static_cast<std::uint16_t>((key - 1) & 0xFFFF),
+                             s.pairs.counts[i].load()});
+        }
+        out.untrackedPairs += s.pairs.overflow.load();
+    }
+
+    // Merge the per-shard entries for the same pair, hottest first
+    std::sort(pairs.begin(), pairs.end(), [](const PairCount &a, const PairCount &b) {
+        return a.from != b.from ? a.from < b.from : a.to < b.to;
+    });
+    for (const PairCount &p : pairs) {
+        if (!out.pairs.empty() && out.pairs.back().from == p.from && out.pairs.back().to == p.to)
+            out.pairs.back().count += p.count;
+        else
+            out.pairs.push_back(p);
+    }
+    std::sort(out.pairs.begin(), out.pairs.end(), [](const PairCount &a, const PairCount &b) {
+        return a.count > b.count;
+    });
+    return out;
+}
+
+void UnitMetrics::reset() {
+    // Counts only; pair slots stay claimed so writers never race a key
+    // reset. Increments racing the reset on other threads may survive it.
+    Registry &r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    for (const std::unique_ptr<Shard> &shard : r.shards) {
+        Shard &s = *shard;
+        for (std::size_t c = 0; c < CategoryCount; ++c) {
+            s.conversions[c].clear();
+            s.batchElements[c].clear();
+            for (Counter &b : s.latency[c]) b.clear();
+        }
+        for (Counter &f : s.fallbacks) f.clear();
+        for (Counter &p : s.pairs.counts) p.clear();
+        s.pairs.overflow.clear();
+    }
+}
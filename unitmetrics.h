@@ -0,0 +1,78 @@
+#ifndef UNITMETRICS_H
+#define UNITMETRICS_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Opt-in counters and latency histograms for the conversion hot path.
+//
+// Disabled by default: the only cost is one relaxed atomic load per call.
+// Enable with UnitMetrics::setEnabled(true) or CONVERTER_METRICS=1 in the
+// environment. When enabled every call bumps a few counters in a
+// thread-private shard (no shared cache lines, no locks); latency is timed
+// for one call in SampleInterval to keep clock reads off most calls.
+// collect() sums all shards, including those of threads that have exited.
+class UnitMetrics
+{
+public:
+    static constexpr std::size_t CategoryCount = 6;    // UnitCategory values
+    static constexpr std::uint32_t SampleInterval = 64;
+
+    enum class Fallback { UnknownUnit, CategoryMismatch, MissingRate };
+    static constexpr std::size_t FallbackCount = 3;
+
+    // Log-linear (HDR-style) histogram of nanoseconds: each power of two
+    // is split into 2^SubBucketBits linear buckets, so every recorded value
+    // is known to within 12.5%. Values past ~9 minutes land in the last one.
+    struct Histogram {
+        static constexpr unsigned SubBucketBits = 3;
+        static constexpr unsigned MaxExponent = 39;
+        static constexpr std::size_t BucketCount = (MaxExponent - SubBucketBits + 2) << SubBucketBits;
+
+        std::array<std::uint64_t, BucketCount> buckets{};
+
+        static std::size_t bucketFor(std::uint64_t ns);
+        static std::uint64_t bucketLowerBound(std::size_t bucket);
+
+        std::uint64_t count() const;
+        // Lower bound of the bucket holding the q-th quantile (0..1)
+        std::uint64_t percentile(double q) const;
+    };
+
+    struct PairCount {
+        std::uint16_t from;
+        std::uint16_t to;
+        std::uint64_t count;
+    };
+
+    // Aggregated view returned by collect()
+    struct Snapshot {
+        std::array<std::uint64_t, CategoryCount> conversions{};     // calls per category
+        std::array<std::uint64_t, CategoryCount> batchElements{};   // elements via convertBatch
+        std::array<std::uint64_t, FallbackCount> fallbacks{};
+        std::array<Histogram, CategoryCount> latency{};             // sampled, ns
+        std::vector<PairCount> pairs;                               // hottest first
+        std::uint64_t untrackedPairs = 0;   // calls whose pair did not fit the per-thread table
+    };
+
+    static bool isEnabled() { return enabled.load(std::memory_order_relaxed); }
+    static void setEnabled(bool on);
+
+    static Snapshot collect();
+    static void reset();
+
+    // -------- recording (called by Units) --------
+    static bool shouldSample();
+    static void recordConversion(std::size_t category, std::uint16_t from, std::uint16_t to);
+    static void recordBatch(std::size_t category, std::uint16_t from, std::uint16_t to, std::size_t elements);
+    static void recordFallback(Fallback reason);
+    static void recordLatency(std::size_t category, std::uint64_t ns);
+
+private:
+    static std::atomic<bool> enabled;
+};
+
+#endif // UNITMETRICS_H
@@ -0,0 +1,153 @@
+#ifndef UNITNAMES_H
+#define UNITNAMES_H
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <string_view>
+
+#include "quantity.h"
+
+// Names and aliases of the built-in units, resolved through a perfect
+// hash generated at compile time.
+//
+// A lookup is one hash, one table load and one compare, with no
+// allocation; a miss is reported as NotFound, never as a near guess.
+// Names are case-sensitive UTF-8 ("m", "metres", "Meters", "°C").
+namespace UnitNames {
+
+// Canonical names of the built-in units, i.e. what Units registers
+inline constexpr std::string_view Builtin[] = {
+    Quantities::Meters::name, Quantities::Feet::name, Quantities::Kilometers::name, Quantities::Miles::name,
+    Quantities::Kilograms::name, Quantities::Pounds::name,
+    Quantities::Liters::name, Quantities::Milliliters::name, Quantities::Gallons::name,
+    Quantities::MetersPerSecond::name, Quantities::KilometersPerHour::name, Quantities::MilesPerHour::name,
+    Quantities::Celsius::name, Quantities::Fahrenheit::name,
+    "USD", "ZAR", "EUR", "GBP", "JPY",
+};
+inline constexpr std::size_t BuiltinCount = std::size(Builtin);
+
+struct Alias {
+    std::string_view name;
+    std::string_view unit;      // canonical name
+};
+
+inline constexpr Alias Aliases[] = {
+    {"m", "Meters"}, {"meter", "Meters"}, {"meters", "Meters"}, {"metre", "Meters"}, {"metres", "Meters"},
+    {"ft", "Feet"}, {"foot", "Feet"}, {"feet", "Feet"},
+    {"km", "Kilometers"}, {"kilometer", "Kilometers"}, {"kilometers", "Kilometers"},
+    {"kilometre", "Kilometers"}, {"kilometres", "Kilometers"},
+    {"mi", "Miles"}, {"mile", "Miles"}, {"miles", "Miles"},
+
+    {"kg", "Kilograms"}, {"kilogram", "Kilograms"}, {"kilograms", "Kilograms"},
+    {"kilogramme", "Kilograms"}, {"kilogrammes", "Kilograms"},
+    {"lb", "Pounds"}, {"lbs", "Pounds"}, {"pound", "Pounds"}, {"pounds", "Pounds"},
+
+    {"L", "Liters"}, {"l", "Liters"}, {"liter", "Liters"}, {"liters", "Liters"},
+    {"litre", "Liters"}, {"litres", "Liters"},
+    {"mL", "Milliliters"}, {"ml", "Milliliters"}, {"milliliter", "Milliliters"}, {"milliliters", "Milliliters"},
+    {"millilitre", "Milliliters"}, {"millilitres", "Milliliters"},
+    {"gal", "Gallons"}, {"gallon", "Gallons"}, {"gallons", "Gallons"},
+
+    {"mps", "m/s"}, {"meter per second", "m/s"}, {"meters per second", "m/s"},
+    {"metre per second", "m/s"}, {"metres per second", "m/s"},
+    {"kph", "km/h"}, {"kmh", "km/h"}, {"km/hr", "km/h"},
+    {"kilometer per hour", "km/h"}, {"kilometers per hour", "km/h"},
+    {"kilometre per hour", "km/h"}, {"kilometres per hour", "km/h"},
+    {"mi/h", "mph"}, {"mile per hour", "mph"}, {"miles per hour", "mph"},
+
+    {"\xC2\xB0" "C", "Celsius"}, {"degC", "Celsius"}, {"celsius", "Celsius"},
+    {"\xC2\xB0" "F", "Fahrenheit"}, {"degF", "Fahrenheit"}, {"fahrenheit", "Fahrenheit"},
+
+    {"usd", "USD"}, {"zar", "ZAR"}, {"eur", "EUR"}, {"gbp", "GBP"}, {"jpy", "JPY"},
+};
+
+inline constexpr std::uint8_t NotFound = 0xFF;
+
+// FNV-1a over code units, so ASCII hashes the same as UTF-8 or UTF-16
+template <class Char>
+constexpr std::uint32_t hash(const Char *s, std::size_t n, std::uint32_t seed) {
+    std::uint32_t h = 2166136261u ^ seed;
+    for (std::size_t i = 0; i < n; ++i) {
+        h ^= static_cast<std::uint32_t>(s[i]);
+        h *= 16777619u;
+    }
+    return h;
+}
+
+struct Entry {
+    std::string_view name;
+    std::uint8_t unit;          // index into Builtin
+};
+
+inline constexpr std::size_t EntryCount = BuiltinCount + std::size(Aliases);
+static_assert(EntryCount < NotFound);
+
+// Sparse enough that a collision-free seed turns up within a few tries
+inline constexpr std::size_t TableSize = std::bit_ceil(EntryCount * EntryCount / 2);
+
+struct Table {
+    std::uint32_t seed = 0;
+    std::array<std::uint8_t, TableSize> slots{};
+    std::array<Entry, EntryCount> entries{};
+};
+
+consteval std::uint8_t builtinIndex(std::string_view name) {
+    for (std::size_t i = 0; i < BuiltinCount; ++i) {
+        if (Builtin[i] == name) return static_cast<std::uint8_t>(i);
+    }
+    throw "alias of an unknown unit";   // not a constant expression: fails the build
+}
+
+consteval Table buildTable() {
+    Table t;
+    for (std::size_t i = 0; i < BuiltinCount; ++i)
+        t.entries[i] = {Builtin[i], static_cast<std::uint8_t>(i)};
+    for (std::size_t i = 0; i < std::size(Aliases); ++i)
+        t.entries[BuiltinCount + i] = {Aliases[i].name, builtinIndex(Aliases[i].unit)};
+
+    for (std::size_t i = 0; i < EntryCount; ++i) {
+        for (std::size_t j = i + 1; j < EntryCount; ++j) {
+            if (t.entries[i].name == t.entries[j].name) throw "duplicate unit name";
+        }
+    }
+
+    for (std::uint32_t seed = 0; seed < 10000; ++seed) {
+        t.slots.fill(NotFound);
+        bool clash = false;
+        for (std::size_t i = 0; i < EntryCount && !clash; ++i) {
+            const std::string_view name = t.entries[i].name;
+            std::uint8_t &slot = t.slots[hash(name.data(), name.size(), seed) & (TableSize - 1)];
+            clash = slot != NotFound;
+            slot = static_cast<std::uint8_t>(i);
+        }
+        if (!clash) {
+            t.seed = seed;
+            return t;
+        }
+    }
+    throw "no perfect hash seed";
+}
+
+inline constexpr Table table = buildTable();
+
+// Index into table.entries of the only entry a name can be, or NotFound
+template <class Char>
+constexpr std::uint8_t candidate(const Char *s, std::size_t n) {
+    return table.slots[hash(s, n, table.seed) & (TableSize - 1)];
+}
+
+// Index into Builtin, or NotFound
+constexpr std::uint8_t find(std::string_view name) {
+    const std::uint8_t i = candidate(name.data(), name.size());
+    return i != NotFound && table.entries[i].name == name ? table.entries[i].unit : NotFound;
+}
+
+static_assert(find("Meters") == 0 && find("metres") == 0 && find("feet") == 1);
+static_assert(find("Metres") == NotFound && find("") == NotFound);
+
+} // namespace UnitNames
+
+#endif // UNITNAMES_H
@@ -1,167 +1,476 @@
 #include "units.h"
+#include "quantity.h"
+#include "trace.h"
+#include "unitcatalog.h"
+#include "unitmetrics.h"
+#include "utf8.h"
 
-std::unique_ptr<Units> Units::instance = nullptr;
+#include <algorithm>
+#include <chrono>
 
 /* ===================== SINGLETON ===================== */
 
 Units& Units::getInstance() {
-    if (!instance) {
-        instance.reset(new Units());
-    }
-    return *instance;
+    // Function-local static: initialisation is thread-safe
+    static Units instance;
+    return instance;
 }
 
 Units::Units() {
     initConversionFactors();
+    storeRates(std::make_shared<const RateSnapshot>());
 }
 
 /* ===================== STATIC FACTORS ===================== */
 
 void Units::initConversionFactors() {
-    lengthFactors["Meters"] = 1.0;
-    lengthFactors["Feet"] = 3.28084;
-    lengthFactors["Kilometers"] = 1000.0;
-    lengthFactors["Miles"] = 1609.34;
+    // Factors come from quantity.h so the typed API cannot drift
+    using namespace Quantities;
+
+    registerUnit(Meters::name, UnitCategory::Length, Meters::factor);
+    registerUnit(Feet::name, UnitCategory::Length, Feet::factor);
+    registerUnit(Kilometers::name, UnitCategory::Length, Kilometers::factor);
+    registerUnit(Miles::name, UnitCategory::Length, Miles::factor);
+
+    registerUnit(Kilograms::name, UnitCategory::Weight, Kilograms::factor);
+    registerUnit(Pounds::name, UnitCategory::Weight, Pounds::factor);
 
-    weightFactors["Kilograms"] = 1.0;
-    weightFactors["Pounds"] = 2.20462;
+    registerUnit(Liters::name, UnitCategory::Volume, Liters::factor);
+    registerUnit(Milliliters::name, UnitCategory::Volume, Milliliters::factor);
+    registerUnit(Gallons::name, UnitCategory::Volume, Gallons::factor);
 
-    volumeFactors["Liters"] = 1.0;
-    volumeFactors["Milliliters"] = 0.001;
-    volumeFactors["Gallons"] = 3.78541;
+    registerUnit(MetersPerSecond::name, UnitCategory::Speed, MetersPerSecond::factor);
+    registerUnit(KilometersPerHour::name, UnitCategory::Speed, KilometersPerHour::factor);
+    registerUnit(MilesPerHour::name, UnitCategory::Speed, MilesPerHour::factor);
 
-    speedFactors["m/s"] = 1.0;
-    speedFactors["km/h"] = 0.277778;
-    speedFactors["mph"] = 0.44704;
+    registerUnit(Celsius::name, UnitCategory::Temperature, Celsius::factor, Celsius::offset);
+    registerUnit(Fahrenheit::name, UnitCategory::Temperature, Fahrenheit::factor, Fahrenheit::offset);
+
+    // Currency (always treat these as currency)
+    registerUnit("USD", UnitCategory::Currency);
+    registerUnit("ZAR", UnitCategory::Currency);
+    registerUnit("EUR", UnitCategory::Currency);
+    registerUnit("GBP", UnitCategory::Currency);
+    registerUnit("JPY", UnitCategory::Currency);
+
+    for (std::size_t c = 0; c < CategoryCount; ++c)
+        rebuildFactorMatrix(static_cast<UnitCategory>(c));
+
+    // Map the compile-time name table onto the IDs just assigned
+    for (std::size_t i = 0; i < UnitNames::BuiltinCount; ++i) {
+        const std::string_view name = UnitNames::Builtin[i];
+        auto it = unitIds.find(QString::fromUtf8(name.data(), qsizetype(name.size())));
+        Q_ASSERT(it != unitIds.end());
+        builtinIds[i] = it->second;
+    }
+    builtinCount = unitTable.size();
 }
 
-/* ===================== UNIT CATEGORY ===================== */
+/* ===================== SYMBOL TABLE ===================== */
 
-UnitCategory Units::getCategory(const QString& unit) const {
+UnitId Units::registerUnit(const QString &name, UnitCategory category,
+                           double factor, double offset) {
+    auto it = unitIds.find(name);
+    if (it != unitIds.end())
+        return it->second;
 
-    // Static categories
-    if (lengthFactors.find(unit) != lengthFactors.end()) return UnitCategory::Length;
-    if (weightFactors.find(unit) != weightFactors.end()) return UnitCategory::Weight;
-    if (volumeFactors.find(unit) != volumeFactors.end()) return UnitCategory::Volume;
-    if (speedFactors.find(unit) != speedFactors.end()) return UnitCategory::Speed;
-    if (unit == "Celsius" || unit == "Fahrenheit") return UnitCategory::Temperature;
+    const UnitId id = static_cast<UnitId>(unitTable.size());
+    const std::uint32_t index = categorySizes[static_cast<std::size_t>(category)]++;
+    unitTable.push_back({name, category, factor, offset, index});
+    unitIds.emplace(name, id);
+    return id;
+}
 
-    // Currency (always treat these as currency)
-    if (unit == "USD" || unit == "ZAR" || unit == "EUR" || unit == "GBP" || unit == "JPY")
-        return UnitCategory::Currency;
+UnitId Units::addUnit(const QString &name, UnitCategory category, double factor, double offset) {
+    const std::size_t before = unitTable.size();
+    UnitId id = registerUnit(name, category, factor, offset);
+    if (unitTable.size() != before)
+        rebuildFactorMatrix(category);
+    return id;
+}
+
+/* ===================== FACTOR MATRICES ===================== */
+
+void Units::rebuildFactorMatrix(UnitCategory category) {
+    FactorMatrix &m = factorMatrices[static_cast<std::size_t>(category)];
+
+    // Currency scales come from live rates, not factors
+    if (category == UnitCategory::Currency) {
+        m = FactorMatrix();
+        return;
+    }
+
+    std::vector<double> factors(categorySizes[static_cast<std::size_t>(category)]);
+    for (const UnitInfo &info : unitTable) {
+        if (info.category == category)
+            factors[info.index] = info.factor;
+    }
+
+    constexpr std::size_t perLine = FactorMatrix::Alignment / sizeof(double);
+    const std::size_t n = factors.size();
+    const std::size_t stride = (n + perLine - 1) / perLine * perLine;
+
+    FactorMatrix fresh;
+    fresh.size = n;
+    fresh.stride = stride;
+    if (n > 0) {
+        void *raw = ::operator new[](n * stride * sizeof(double), std::align_val_t(FactorMatrix::Alignment));
+        fresh.scales.reset(static_cast<double *>(raw));
+        for (std::size_t i = 0; i < n; ++i) {
+            for (std::size_t j = 0; j < stride; ++j)
+                fresh.scales[i * stride + j] = j < n ? factors[j] / factors[i] : 0.0;
+        }
+    }
+    m = std::move(fresh);
+}
+
+UnitId Units::unitId(std::string_view unit) const {
+    const std::uint8_t builtin = UnitNames::find(unit);
+    if (builtin != UnitNames::NotFound)
+        return builtinIds[builtin];
+    if (unitTable.size() == builtinCount)
+        return InvalidUnitId;
+    return addedUnitId(QString::fromUtf8(unit.data(), qsizetype(unit.size())));
+}
+
+UnitId Units::unitId(QStringView unit) const {
+    // ASCII hashes and compares the same in UTF-16; only other names
+    // (e.g. "°C") are transcoded, on the stack
+    bool ascii = true;
+    for (qsizetype i = 0; i < unit.size() && ascii; ++i)
+        ascii = unit[i].unicode() < 0x80;
+
+    if (ascii) {
+        const std::uint8_t i = UnitNames::candidate(unit.utf16(), std::size_t(unit.size()));
+        if (i != UnitNames::NotFound) {
+            const UnitNames::Entry &e = UnitNames::table.entries[i];
+            if (e.name.size() == std::size_t(unit.size()) && std::equal(e.name.begin(), e.name.end(), unit.utf16()))
+                return builtinIds[e.unit];
+        }
+    } else {
+        char utf8[64];
+        const Utf8::Encoded e = Utf8::encode(unit, utf8, sizeof(utf8));
+        // Cut short means longer than any built-in name
+        const std::uint8_t builtin = e.complete ? UnitNames::find(std::string_view(utf8, e.size)) : UnitNames::NotFound;
+        if (builtin != UnitNames::NotFound)
+            return builtinIds[builtin];
+    }
+    return unitTable.size() == builtinCount ? InvalidUnitId : addedUnitId(unit);
+}
 
-    return UnitCategory::Length; // fallback
+// Units registered through addUnit, by exact name
+UnitId Units::addedUnitId(QStringView unit) const {
+    auto it = unitIds.find(unit.toString());
+    return it != unitIds.end() ? it->second : InvalidUnitId;
+}
+
+/* ===================== UNIT CATEGORY ===================== */
+
+bool Units::getCategory(QStringView unit, UnitCategory &category) const {
+    const UnitId id = unitId(unit);
+    if (id == InvalidUnitId)
+        return false;
+    category = unitTable[id].category;
+    return true;
 }
 
 /* ===================== CONVERSION ENGINE ===================== */
 
-double Units::convert(const QString &from, const QString &to, double value) {
-    UnitCategory category = getCategory(from);
-    if (category != getCategory(to))
-        return value; // mismatched categories -> do nothing
+double Units::convert(const QString &from, const QString &to, double value) const {
+    // Resolve both names once, then stay on the dense-index path
+    const UnitId a = unitId(from);
+    const UnitId b = unitId(to);
+    if (a == InvalidUnitId || b == InvalidUnitId) [[unlikely]] {
+        const ConversionPlan p = UnitCatalog::builtin().plan(from, to);
+        if (p.isValid()) return p.apply(value);
+    }
+    return convert(a, b, value);
+}
 
-    switch (category) {
+double Units::convert(UnitId from, UnitId to, double value) const {
+    if (UnitMetrics::isEnabled()) [[unlikely]]
+        return convertRecorded(from, to, value);
+    return plan(from, to).apply(value);
+}
 
-    /* ----- LENGTH ----- */
-    case UnitCategory::Length:
-        if (lengthFactors.find(from) != lengthFactors.end() &&
-            lengthFactors.find(to) != lengthFactors.end())
-            return value * (lengthFactors.at(to) / lengthFactors.at(from));
-        return value;
+ConversionPlan Units::plan(const QString &from, const QString &to) const {
+    const UnitId a = unitId(from);
+    const UnitId b = unitId(to);
+    if (a == InvalidUnitId || b == InvalidUnitId) [[unlikely]]
+        return UnitCatalog::builtin().plan(from, to);
+    return plan(a, b);
+}
 
-    /* ----- WEIGHT ----- */
-    case UnitCategory::Weight:
-        if (weightFactors.find(from) != weightFactors.end() &&
-            weightFactors.find(to) != weightFactors.end())
-            return value * (weightFactors.at(to) / weightFactors.at(from));
-        return value;
+ConversionPlan Units::plan(UnitId from, UnitId to) const {
+    // Only currency needs rates; skip the snapshot refcount for the rest
+    if (isValid(from) && unitTable[from].category == UnitCategory::Currency)
+        return plan(from, to, *rateSnapshot());
 
-    /* ----- VOLUME ----- */
-    case UnitCategory::Volume:
-        if (volumeFactors.find(from) != volumeFactors.end() &&
-            volumeFactors.find(to) != volumeFactors.end())
-            return value * (volumeFactors.at(to) / volumeFactors.at(from));
-        return value;
+    static const RateSnapshot noRates;
+    return plan(from, to, noRates);
+}
+
+ConversionPlan Units::plan(UnitId from, UnitId to, const RateSnapshot &rates) const {
+    if (!isValid(from) || !isValid(to))
+        return ConversionPlan::invalid(); // unknown unit -> do nothing
 
-    /* ----- SPEED ----- */
+    const UnitInfo &src = unitTable[from];
+    const UnitInfo &dst = unitTable[to];
+    if (src.category != dst.category)
+        return ConversionPlan::invalid(); // mismatched categories -> do nothing
+
+    switch (src.category) {
+
+    /* ----- LENGTH / WEIGHT / VOLUME / SPEED / TEMPERATURE ----- */
+    case UnitCategory::Length:
+    case UnitCategory::Weight:
+    case UnitCategory::Volume:
     case UnitCategory::Speed:
-        if (speedFactors.find(from) != speedFactors.end() &&
-            speedFactors.find(to) != speedFactors.end())
-            return value * (speedFactors.at(to) / speedFactors.at(from));
-        return value;
-
-    /* ----- TEMPERATURE ----- */
-    case UnitCategory::Temperature:
-        if (from == "Celsius" && to == "Fahrenheit")
-            return (value * 9.0 / 5.0) + 32;
-        if (from == "Fahrenheit" && to == "Celsius")
-            return (value - 32) * 5.0 / 9.0;
-        return value;
+    case UnitCategory::Temperature: {
+        // dst = (src - src.offset) / src.factor * dst.factor + dst.offset
+        const double scale = factorMatrix(src.category).scale(src.index, dst.index);
+        return ConversionPlan::affine(scale, dst.offset - src.offset * scale);
+    }
 
     /* ----- CURRENCY (API-fed values) ----- */
     case UnitCategory::Currency: {
+        // Published snapshots map currency units straight to rate slots
+        const std::uint32_t a = rates.unitSlot(src.index);
+        const std::uint32_t b = rates.unitSlot(dst.index);
+        if (a != RateSnapshot::npos && b != RateSnapshot::npos) {
+            const double ra = rates.baseRate(a);
+            const double rb = rates.baseRate(b);
+            if (ra > 0.0 && rb > 0.0)
+                return ConversionPlan::affine(rb / ra);
+            return ConversionPlan::invalid();
+        }
+
         double rate = 0.0;
-        if (getCurrencyRate(from, to, rate))
-            return value * rate;
+        if (rates.rate(src.name, dst.name, rate))
+            return ConversionPlan::affine(rate);
 
-        return value; // fallback if API not ready
+        return ConversionPlan::invalid(); // fallback if API not ready
     }
     }
 
-    return value;
+    return ConversionPlan::invalid();
 }
 
-/* ===================== UI POPULATION ===================== */
+/* ===================== BATCH CONVERSION ===================== */
+
+void Units::convertBatch(const QString &from, const QString &to,
+                         std::span<const double> in, std::span<double> out) const {
+    const UnitId a = unitId(from);
+    const UnitId b = unitId(to);
+    if (a == InvalidUnitId || b == InvalidUnitId) [[unlikely]] {
+        const ConversionPlan p = UnitCatalog::builtin().plan(from, to);
+        if (p.isValid()) {
+            p.apply(in, out);
+            return;
+        }
+    }
+    convertBatch(a, b, in, out);
+}
 
-void Units::populateUnits(QComboBox *combo, UnitCategory category) {
-    if (!combo) return;
+void Units::convertBatch(UnitId from, UnitId to,
+                         std::span<const double> in, std::span<double> out) const {
+    const ConversionPlan p = plan(from, to);
+    if (UnitMetrics::isEnabled()) [[unlikely]]
+        recordBatch(from, to, p, std::min(in.size(), out.size()));
+    p.apply(in, out);
+}
 
-    combo->clear();
+void Units::convertBatch(UnitId from, UnitId to,
+                         std::span<const double> in, std::span<double> out,
+                         WorkStealingPool &pool) const {
+    const ConversionPlan p = plan(from, to);
+    if (UnitMetrics::isEnabled()) [[unlikely]]
+        recordBatch(from, to, p, std::min(in.size(), out.size()));
+    p.apply(in, out, pool);
+}
 
-    switch (category) {
+/* ===================== METRICS ===================== */
 
-    case UnitCategory::Length:
-        combo->addItems({"Meters", "Feet", "Kilometers", "Miles"});
-        break;
+double Units::convertRecorded(UnitId from, UnitId to, double value) const {
+    using Clock = std::chrono::steady_clock;
 
-    case UnitCategory::Weight:
-        combo->addItems({"Kilograms", "Pounds"});
-        break;
+    const bool sample = UnitMetrics::shouldSample();
+    const Clock::time_point start = sample ? Clock::now() : Clock::time_point();
 
-    case UnitCategory::Temperature:
-        combo->addItems({"Celsius", "Fahrenheit"});
-        break;
+    const ConversionPlan p = plan(from, to);
+    const double result = p.apply(value);
 
-    case UnitCategory::Volume:
-        combo->addItems({"Liters", "Milliliters", "Gallons"});
-        break;
+    if (sample && p.isValid()) {
+        const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+        UnitMetrics::recordLatency(static_cast<std::size_t>(unitTable[from].category),
+                                   static_cast<std::uint64_t>(ns));
+    }
+    if (p.isValid())
+        UnitMetrics::recordConversion(static_cast<std::size_t>(unitTable[from].category), from, to);
+    else
+        recordFallback(from, to);
+    return result;
+}
 
-    case UnitCategory::Speed:
-        combo->addItems({"m/s", "km/h", "mph"});
-        break;
+void Units::recordBatch(UnitId from, UnitId to, const ConversionPlan &p, std::size_t elements) const {
+    if (p.isValid())
+        UnitMetrics::recordBatch(static_cast<std::size_t>(unitTable[from].category), from, to, elements);
+    else
+        recordFallback(from, to);
+}
+
+// Works out why plan() gave up, i.e. why the input is passed through unchanged
+void Units::recordFallback(UnitId from, UnitId to) const {
+    if (!isValid(from) || !isValid(to))
+        UnitMetrics::recordFallback(UnitMetrics::Fallback::UnknownUnit);
+    else if (unitTable[from].category != unitTable[to].category)
+        UnitMetrics::recordFallback(UnitMetrics::Fallback::CategoryMismatch);
+    else
+        UnitMetrics::recordFallback(UnitMetrics::Fallback::MissingRate);
+}
+
+/* ===================== DISPLAY LISTS ===================== */
 
-    case UnitCategory::Currency:
+const QStringList& Units::displayUnits(UnitCategory category) const {
+    static const std::array<QStringList, CategoryCount> lists = {
+        QStringList{"Meters", "Feet", "Kilometers", "Miles"},       // Length
+        QStringList{"Kilograms", "Pounds"},                         // Weight
+        QStringList{"Celsius", "Fahrenheit"},                       // Temperature
+        QStringList{"Liters", "Milliliters", "Gallons"},            // Volume
+        QStringList{"m/s", "km/h", "mph"},                          // Speed
         // Static list; API will fill values later
-        combo->addItems({"USD", "ZAR", "EUR", "GBP", "JPY"});
-        break;
-    }
+        QStringList{"USD", "ZAR", "EUR", "GBP", "JPY"},             // Currency
+    };
+    return lists[static_cast<std::size_t>(category)];
 }
 
 /* ===================== CURRENCY RATE STORAGE ===================== */
 
-void Units::setCurrencyRate(const QString &from, const QString &to, double rate) {
-    currencyRates[from][to] = rate;
+namespace {
+
+// One hazard pointer per thread. Records are never freed: a thread that
+// exits hands its record to the next new thread.
+struct HazardRecord {
+    std::atomic<const RateSnapshot *> pointer{nullptr};
+    std::atomic<bool> inUse{true};
+    HazardRecord *next = nullptr;
+};
+
+std::atomic<HazardRecord *> hazardRecords{nullptr};
+
+HazardRecord *acquireHazard() {
+    for (HazardRecord *r = hazardRecords.load(std::memory_order_acquire); r; r = r->next) {
+        bool free = false;
+        if (!r->inUse.load(std::memory_order_relaxed)
+            && r->inUse.compare_exchange_strong(free, true, std::memory_order_acquire))
+            return r;
+    }
+
+    HazardRecord *r = new HazardRecord;
+    r->next = hazardRecords.load(std::memory_order_relaxed);
+    while (!hazardRecords.compare_exchange_weak(r->next, r, std::memory_order_release, std::memory_order_relaxed)) {}
+    return r;
 }
 
-bool Units::getCurrencyRate(const QString &from, const QString &to, double &outRate) const {
-    auto itFrom = currencyRates.find(from);
-    if (itFrom == currencyRates.end())
-        return false;
+struct ThreadHazard {
+    HazardRecord *record = acquireHazard();
+    ~ThreadHazard() {
+        record->pointer.store(nullptr, std::memory_order_release);
+        record->inUse.store(false, std::memory_order_release);
+    }
+};
 
-    auto itTo = itFrom->second.find(to);
-    if (itTo == itFrom->second.end())
-        return false;
+HazardRecord &threadHazard() {
+    thread_local ThreadHazard hazard;
+    return *hazard.record;
+}
 
-    outRate = itTo->second;
+// Publishes `p` as in use, then checks it is still current; a writer that
+// swaps it out after the first check sees the hazard when it scans
+const RateSnapshot *protect(HazardRecord &hazard, const std::atomic<const RateSnapshot *> &current) {
+    const RateSnapshot *p = current.load(std::memory_order_relaxed);
+    for (;;) {
+        hazard.pointer.store(p, std::memory_order_seq_cst);
+        const RateSnapshot *q = current.load(std::memory_order_seq_cst);
+        if (q == p) return p;
+        p = q;
+    }
+}
+
+bool isHazard(const RateSnapshot *p) {
+    for (HazardRecord *r = hazardRecords.load(std::memory_order_acquire); r; r = r->next) {
+        if (r->pointer.load(std::memory_order_seq_cst) == p) return true;
+    }
+    return false;
+}
+
+} // namespace
+
+RateSnapshotPtr Units::rateSnapshot() const {
+    HazardRecord &hazard = threadHazard();
+    RateSnapshotPtr pinned = protect(hazard, currentRates)->shared_from_this();
+    hazard.pointer.store(nullptr, std::memory_order_release);
+    if (ratesRetiredPending.load(std::memory_order_relaxed)) reclaimRetiredRates();
+    return pinned;
+}
+
+// Called with ratesWriteMutex held (or before the singleton is shared)
+void Units::storeRates(RateSnapshotPtr rates) {
+    if (publishedRates) retiredRates.push_back(std::move(publishedRates));
+    publishedRates = std::move(rates);
+    currentRates.store(publishedRates.get(), std::memory_order_seq_cst);
+
+    // Drop replaced snapshots no reader is inside; readers that took a
+    // reference keep theirs alive on their own
+    std::erase_if(retiredRates, [](const RateSnapshotPtr &old) { return !isHazard(old.get()); });
+    ratesRetiredPending.store(!retiredRates.empty(), std::memory_order_relaxed);
+}
+
+// Rescans what storeRates() had to keep because a reader was inside it.
+// Hazards last a few instructions, so by the next read they are normally
+// gone. Never waits: with a writer in progress, its own scan covers this.
+void Units::reclaimRetiredRates() const {
+    std::unique_lock<std::mutex> lock(ratesWriteMutex, std::try_to_lock);
+    if (!lock.owns_lock()) return;
+    std::erase_if(retiredRates, [](const RateSnapshotPtr &old) { return !isHazard(old.get()); });
+    ratesRetiredPending.store(!retiredRates.empty(), std::memory_order_relaxed);
+}
+
+void Units::assignUnitSlots(RateSnapshot &rates) const {
+    rates.unitSlots.assign(categorySizes[static_cast<std::size_t>(UnitCategory::Currency)],
+                           RateSnapshot::npos);
+    for (const UnitInfo &info : unitTable) {
+        if (info.category == UnitCategory::Currency)
+            rates.unitSlots[info.index] = rates.currencyIndex(info.name);
+    }
+}
+
+std::uint64_t Units::publishRates(RateSnapshot rates) {
+    TRACE_SCOPE("Units::publishRates");
+    assignUnitSlots(rates);
+
+    std::lock_guard<std::mutex> lock(ratesWriteMutex);
+    rates.ver = publishedRates->version() + 1;
+    const std::uint64_t version = rates.ver;
+    storeRates(std::make_shared<const RateSnapshot>(std::move(rates)));
+    return version;
+}
+
+bool Units::setCurrencyRate(const QString &from, const QString &to, double rate) {
+    std::lock_guard<std::mutex> lock(ratesWriteMutex);
+    RateSnapshot next = *publishedRates;
+    if (!next.setRate(from, to, rate))
+        return false;
+    assignUnitSlots(next);
+    ++next.ver;
+    storeRates(std::make_shared<const RateSnapshot>(std::move(next)));
     return true;
 }
+
+bool Units::getCurrencyRate(const QString &from, const QString &to, double &outRate) const {
+    HazardRecord &hazard = threadHazard();
+    const bool found = protect(hazard, currentRates)->rate(from, to, outRate);
+    hazard.pointer.store(nullptr, std::memory_order_release);
+    if (ratesRetiredPending.load(std::memory_order_relaxed)) reclaimRetiredRates();
+    return found;
+}
@@ -2,23 +2,98 @@
 #define UNITS_H
 
 #include <QString>
-#include <QComboBox>
+#include <QStringList>
+#include <QStringView>
 #include <unordered_map>
 #include <memory>
+#include <vector>
+#include <array>
+#include <new>
+#include <cstdint>
+#include <span>
+#include <atomic>
+#include <mutex>
+#include <string_view>
+
+#include "conversionplan.h"
+#include "ratesnapshot.h"
+#include "unitnames.h"
+
+class WorkStealingPool;
 
 enum class UnitCategory { Length, Weight, Temperature, Volume, Speed, Currency };
 
+// Small dense handle for a registered unit. Resolve it once with
+// Units::unitId() and reuse it to skip string hashing on every conversion.
+using UnitId = std::uint16_t;
+inline constexpr UnitId InvalidUnitId = 0xFFFF;
+
 class Units
 {
 public:
     static Units& getInstance();
 
-    double convert(const QString &from, const QString &to, double value);
-    void populateUnits(QComboBox* combo, UnitCategory category);
-    UnitCategory getCategory(const QString& unit) const;
+    // Names this table does not know are looked up in the full
+    // UnitCatalog (ID overloads cover registered units only)
+    double convert(const QString &from, const QString &to, double value) const;
+    double convert(UnitId from, UnitId to, double value) const;
+
+    // Resolves a conversion once for reuse; see ConversionPlan.
+    // Currency plans capture the rate current at planning time.
+    ConversionPlan plan(const QString &from, const QString &to) const;
+    ConversionPlan plan(UnitId from, UnitId to) const;
+    ConversionPlan plan(UnitId from, UnitId to, const RateSnapshot &rates) const;
+
+    // Converts in[i] into out[i] for min(in.size(), out.size()) elements.
+    // The conversion is resolved once and then run through a SIMD kernel;
+    // results match convert() bit for bit. `in` and `out` may alias.
+    void convertBatch(const QString &from, const QString &to,
+                      std::span<const double> in, std::span<double> out) const;
+    void convertBatch(UnitId from, UnitId to,
+                      std::span<const double> in, std::span<double> out) const;
+
+    // Parallel variant for very large arrays; output is identical to the
+    // single-threaded call. Use WorkStealingPool::global() unless the job
+    // needs its own thread count.
+    void convertBatch(UnitId from, UnitId to,
+                      std::span<const double> in, std::span<double> out,
+                      WorkStealingPool &pool) const;
+
+    // Units offered for selection in a category, in display order.
+    // Widgets are filled through UnitCombo::populate (GUI side).
+    const QStringList& displayUnits(UnitCategory category) const;
+
+    // False for names that are not a known unit or alias
+    bool getCategory(QStringView unit, UnitCategory &category) const;
+
+    // --------  Unit symbol table --------
+    // Built-in names and aliases ("Meters", "m", "metres"; see UnitNames)
+    // resolve with one hash and one compare and never allocate. Unknown
+    // names give InvalidUnitId.
+    UnitId unitId(QStringView unit) const;
+    UnitId unitId(std::string_view unit) const;     // UTF-8
+    const QString& unitName(UnitId id) const { return unitTable[id].name; }
+    UnitCategory unitCategory(UnitId id) const { return unitTable[id].category; }
+    bool isValid(UnitId id) const { return id < unitTable.size(); }
+    std::size_t unitCount() const { return unitTable.size(); }
+
+    // Registers a unit (or returns the existing ID) and rebuilds its
+    // category's factor matrix. Not safe while other threads convert.
+    UnitId addUnit(const QString& name, UnitCategory category, double factor = 1.0, double offset = 0.0);
 
     // --------  Currency rate management --------
-    void setCurrencyRate(const QString& from, const QString& to, double rate);
+    // Readers are lock-free: they protect the current snapshot with a
+    // per-thread hazard pointer (two stores and a load, retried only if a
+    // publish lands in between). rateSnapshot() then takes a reference
+    // (one atomic increment); getCurrencyRate() reads in place and takes
+    // none. Writers build a complete RateSnapshot and swap it in whole.
+    RateSnapshotPtr rateSnapshot() const;
+    std::uint64_t publishRates(RateSnapshot rates);
+
+    // Copies the current snapshot to change one rate; prefer publishRates
+    // for bulk updates. False if the pair cannot be related to the current
+    // rates (see RateSnapshot::setRate); nothing is published then.
+    bool setCurrencyRate(const QString& from, const QString& to, double rate);
     bool getCurrencyRate(const QString& from, const QString& to, double& outRate) const;
 
 private:
@@ -27,16 +102,69 @@ private:
     Units& operator=(const Units&) = delete;
 
     void initConversionFactors();
+    UnitId registerUnit(const QString& name, UnitCategory category,
+                        double factor = 1.0, double offset = 0.0);
 
-    std::unordered_map<QString, double> lengthFactors;
-    std::unordered_map<QString, double> weightFactors;
-    std::unordered_map<QString, double> volumeFactors;
-    std::unordered_map<QString, double> speedFactors;
+    struct UnitInfo {
+        QString name;
+        UnitCategory category;
+        double factor;      // value = base * factor + offset
+        double offset;
+        std::uint32_t index;  // row/column in the category factor matrix
+    };
+
+    // Dense from->to scales for one category, row-major with each row
+    // padded to a whole cache line. scale(i, j) == factor[j] / factor[i].
+    struct FactorMatrix {
+        static constexpr std::size_t Alignment = 64;
+
+        struct AlignedDelete {
+            void operator()(double *p) const { ::operator delete[](p, std::align_val_t(Alignment)); }
+        };
+
+        std::size_t size = 0;
+        std::size_t stride = 0;
+        std::unique_ptr<double[], AlignedDelete> scales;
+
+        double scale(std::uint32_t from, std::uint32_t to) const { return scales[from * stride + to]; }
+    };
+
+    static constexpr std::size_t CategoryCount = static_cast<std::size_t>(UnitCategory::Currency) + 1;
+
+    void rebuildFactorMatrix(UnitCategory category);
+    const FactorMatrix &factorMatrix(UnitCategory category) const {
+        return factorMatrices[static_cast<std::size_t>(category)];
+    }
+
+    UnitId addedUnitId(QStringView unit) const;
+
+    std::vector<UnitInfo> unitTable;                // indexed by UnitId
+    std::unordered_map<QString, UnitId> unitIds;    // name -> UnitId
+    std::array<UnitId, UnitNames::BuiltinCount> builtinIds{};   // UnitNames::Builtin index -> UnitId
+    std::size_t builtinCount = 0;                   // units registered before any addUnit
+    std::array<FactorMatrix, CategoryCount> factorMatrices;
+    std::array<std::uint32_t, CategoryCount> categorySizes{};
+
+    // -------- metrics (see UnitMetrics) --------
+    double convertRecorded(UnitId from, UnitId to, double value) const;
+    void recordBatch(UnitId from, UnitId to, const ConversionPlan &plan, std::size_t elements) const;
+    void recordFallback(UnitId from, UnitId to) const;
 
     // -------- currency rates --------
-    std::unordered_map<QString, std::unordered_map<QString, double>> currencyRates;
+    void storeRates(RateSnapshotPtr rates);
+    void assignUnitSlots(RateSnapshot &rates) const;
+
+    void reclaimRetiredRates() const;
 
-    static std::unique_ptr<Units> instance;
+    // Readers load currentRates under a hazard pointer; the writer keeps
+    // the owning reference and releases replaced snapshots once no hazard
+    // points at them. One still hazarded at publish is freed by the next
+    // read that finds the write lock free, not left until the next publish.
+    std::atomic<const RateSnapshot *> currentRates{nullptr};
+    RateSnapshotPtr publishedRates;                     // writer only
+    mutable std::vector<RateSnapshotPtr> retiredRates;  // under ratesWriteMutex, still pinned
+    mutable std::atomic<bool> ratesRetiredPending{false};
+    mutable std::mutex ratesWriteMutex;     // serialises writers; readers only ever try_lock it
 };
 
 #endif // UNITS_H
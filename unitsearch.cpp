@@ -0,0 +1,197 @@
+#include "unitsearch.h"
+#include "utf8.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace {
+
+// Scores by kind of match; within a kind, closer lengths score higher
+constexpr std::uint32_t ExactScore = 4000;
+constexpr std::uint32_t PrefixScore = 3000;
+constexpr std::uint32_t SubstringScore = 2000;
+constexpr std::uint32_t TrigramScore = 1000;
+
+// Longest query considered; longer input is cut
+constexpr std::size_t MaxQuery = 64;
+
+char foldCase(char c) {
+    return (c >= 'A' && c <= 'Z') ? static_cast<char>(c + ('a' - 'A')) : c;
+}
+
+std::uint32_t trigramAt(const char *p) {
+    return static_cast<std::uint32_t>(static_cast<unsigned char>(p[0])) << 16
+         | static_cast<std::uint32_t>(static_cast<unsigned char>(p[1])) << 8
+         | static_cast<std::uint32_t>(static_cast<unsigned char>(p[2]));
+}
+
+// Bigrams are kept in the same posting lists, above every trigram
+constexpr std::uint32_t BigramMark = 1u << 24;
+
+std::uint32_t bigramAt(const char *p) {
+    return BigramMark
+         | static_cast<std::uint32_t>(static_cast<unsigned char>(p[0])) << 8
+         | static_cast<std::uint32_t>(static_cast<unsigned char>(p[1]));
+}
+
+template <class Fn>
+void forEachBigram(std::string_view text, Fn fn) {
+    for (std::size_t i = 0; i + 2 <= text.size(); ++i)
+        fn(bigramAt(text.data() + i));
+}
+
+// Trigrams of " " + text: the leading space favours matches at the start
+template <class Fn>
+void forEachTrigram(std::string_view text, Fn fn) {
+    if (text.empty()) return;
+    char padded[256];       // keys are at most 255 bytes
+    padded[0] = ' ';
+    const std::size_t n = std::min(text.size(), sizeof(padded) - 1);
+    std::copy_n(text.data(), n, padded + 1);
+    for (std::size_t i = 0; i + 3 <= n + 1; ++i)
+        fn(trigramAt(padded + i));
+}
+
+std::uint32_t closeness(std::size_t keyLength, std::size_t queryLength) {
+    const std::size_t extra = keyLength > queryLength ? keyLength - queryLength : queryLength - keyLength;
+    return static_cast<std::uint32_t>(255 - std::min<std::size_t>(extra, 255));
+}
+
+} // namespace
+
+/* ===================== BUILD ===================== */
+
+void UnitSearch::add(std::uint32_t item, std::string_view key) {
+    const std::size_t length = std::min<std::size_t>(key.size(), 255);
+    if (length == 0) return;
+
+    const std::uint32_t text = static_cast<std::uint32_t>(arena.size());
+    for (std::size_t i = 0; i < length; ++i)
+        arena.push_back(foldCase(key[i]));
+    keys.push_back({text, item, static_cast<std::uint8_t>(length)});
+}
+
+void UnitSearch::build() {
+    sorted.resize(keys.size());
+    for (std::uint32_t i = 0; i < sorted.size(); ++i) sorted[i] = i;
+    std::sort(sorted.begin(), sorted.end(), [this](std::uint32_t a, std::uint32_t b) {
+        const std::string_view ta = keyText(a), tb = keyText(b);
+        return ta != tb ? ta < tb : a < b;
+    });
+
+    // (gram, key) pairs, grouped into CSR posting lists
+    std::vector<std::pair<std::uint32_t, std::uint32_t>> pairs;
+    pairs.reserve(2 * arena.size());
+    for (std::uint32_t k = 0; k < keys.size(); ++k) {
+        forEachTrigram(keyText(k), [&](std::uint32_t t) { pairs.emplace_back(t, k); });
+        forEachBigram(keyText(k), [&](std::uint32_t b) { pairs.emplace_back(b, k); });
+    }
+    std::sort(pairs.begin(), pairs.end());
+    pairs.erase(std::unique(pairs.begin(), pairs.end()), pairs.end());
+
+    grams.clear();
+    offsets.clear();
+    postings.clear();
+    postings.reserve(pairs.size());
+    for (const auto &[t, k] : pairs) {
+        if (grams.empty() || grams.back() != t) {
+            grams.push_back(t);
+            offsets.push_back(static_cast<std::uint32_t>(postings.size()));
+        }
+        postings.push_back(k);
+    }
+    offsets.push_back(static_cast<std::uint32_t>(postings.size()));
+}
+
+/* ===================== SEARCH ===================== */
+
+std::span<const std::uint32_t> UnitSearch::keysWith(std::uint32_t gram) const {
+    const auto pos = std::lower_bound(grams.begin(), grams.end(), gram);
+    if (pos == grams.end() || *pos != gram) return {};
+    const std::size_t i = static_cast<std::size_t>(pos - grams.begin());
+    return std::span<const std::uint32_t>(postings).subspan(offsets[i], offsets[i + 1] - offsets[i]);
+}
+
+void UnitSearch::search(std::string_view query, std::vector<Match> &out, std::size_t limit) const {
+    out.clear();
+    char folded[MaxQuery];
+    const std::size_t n = std::min(query.size(), MaxQuery);
+    for (std::size_t i = 0; i < n; ++i) folded[i] = foldCase(query[i]);
+    const std::string_view q(folded, n);
+    if (q.empty() || limit == 0 || keys.empty()) return;
+
+    // Best score per key that matched at all
+    std::vector<std::pair<std::uint32_t, std::uint32_t>> scored;     // key, score
+
+    // Prefix and exact matches: one range of the sorted keys
+    auto first = std::lower_bound(sorted.begin(), sorted.end(), q, [this](std::uint32_t k, std::string_view v) {
+        return keyText(k) < v;
+    });
+    for (auto it = first; it != sorted.end() && keyText(*it).substr(0, q.size()) == q; ++it) {
+        const std::size_t length = keys[*it].length;
+        scored.emplace_back(*it, (length == q.size() ? ExactScore : PrefixScore) + closeness(length, q.size()));
+    }
+
+    // Two bytes: every key holding them is a substring match
+    if (q.size() == 2) {
+        for (std::uint32_t k : keysWith(bigramAt(q.data()))) {
+            if (keyText(k).substr(0, 2) == q) continue;     // scored as a prefix already
+            scored.emplace_back(k, SubstringScore + closeness(keys[k].length, q.size()));
+        }
+    }
+
+    // Substring and fuzzy matches: count shared trigrams per key
+    if (q.size() >= 3) {
+        std::vector<std::uint32_t> queryTrigrams;
+        forEachTrigram(q, [&](std::uint32_t t) { queryTrigrams.push_back(t); });
+        std::sort(queryTrigrams.begin(), queryTrigrams.end());
+        queryTrigrams.erase(std::unique(queryTrigrams.begin(), queryTrigrams.end()), queryTrigrams.end());
+
+        std::vector<std::uint16_t> shared(keys.size(), 0);
+        std::vector<std::uint32_t> touched;
+        for (std::uint32_t t : queryTrigrams) {
+            for (std::uint32_t k : keysWith(t)) {
+                if (shared[k]++ == 0) touched.push_back(k);
+            }
+        }
+
+        // At least half of the query's trigrams, so noise stays out
+        const std::size_t needed = (queryTrigrams.size() + 1) / 2;
+        for (std::uint32_t k : touched) {
+            if (shared[k] < needed) continue;
+            const std::string_view text = keyText(k);
+            if (text.substr(0, q.size()) == q) continue;    // scored as a prefix already
+            const std::uint32_t score = text.find(q) != std::string_view::npos
+                ? SubstringScore + closeness(text.size(), q.size())
+                : TrigramScore + static_cast<std::uint32_t>(shared[k] * 512 / queryTrigrams.size())
+                               + closeness(text.size(), q.size());
+            scored.emplace_back(k, score);
+        }
+    }
+
+    // Best key per item, then best items first
+    for (const auto &[k, score] : scored)
+        out.push_back({keys[k].item, score});
+    std::sort(out.begin(), out.end(), [](const Match &a, const Match &b) {
+        return a.item != b.item ? a.item < b.item : a.score > b.score;
+    });
+    out.erase(std::unique(out.begin(), out.end(), [](const Match &a, const Match &b) { return a.item == b.item; }),
+              out.end());
+
+    const auto better = [](const Match &a, const Match &b) {
+        return a.score != b.score ? a.score > b.score : a.item < b.item;
+    };
+    if (out.size() > limit) {
+        std::partial_sort(out.begin(), out.begin() + static_cast<std::ptrdiff_t>(limit), out.end(), better);
+        out.resize(limit);
+    } else {
+        std::sort(out.begin(), out.end(), better);
+    }
+}
+
+void UnitSearch::search(QStringView query, std::vector<Match> &out, std::size_t limit) const {
+    // On the stack, cut at MaxQuery bytes
+    char utf8[MaxQuery];
+    const Utf8::Encoded e = Utf8::encode(query, utf8, sizeof(utf8));
+    search(std::string_view(utf8, e.size), out, limit);
+}
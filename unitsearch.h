@@ -0,0 +1,66 @@
+#ifndef UNITSEARCH_H
+#define UNITSEARCH_H
+
+#include <QStringView>
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <vector>
+
+// Search-as-you-type index over unit names.
+//
+// Items (e.g. rows of a unit list) are added with any number of keys:
+// symbols, names, aliases. build() then lays out two read-only indexes:
+// every key sorted, for prefix matches, and a posting list per two- and
+// three-byte sequence: bigrams answer two-byte queries anywhere in a key
+// ("lo": kilometre), trigrams longer substrings and misspellings
+// ("kilomter"). Matching ignores ASCII case.
+//
+// Ranking, best first: exact key, key prefix (shorter keys first),
+// substring, then trigram overlap; an item scores as its best key and
+// ties keep item order. A query takes well under a millisecond on 10k
+// items. Searching is const and safe from several threads.
+class UnitSearch
+{
+public:
+    struct Match {
+        std::uint32_t item;
+        std::uint32_t score;
+    };
+
+    // UTF-8 key for `item`; keys longer than 255 bytes are cut
+    void add(std::uint32_t item, std::string_view key);
+    void build();
+
+    // Up to `limit` items, best first; an empty query matches nothing
+    void search(std::string_view query, std::vector<Match> &out, std::size_t limit) const;
+    void search(QStringView query, std::vector<Match> &out, std::size_t limit) const;
+
+    std::size_t keyCount() const { return keys.size(); }
+
+private:
+    struct Key {
+        std::uint32_t text;         // arena offset, lower-cased
+        std::uint32_t item;
+        std::uint8_t length;
+    };
+
+    std::string_view keyText(std::uint32_t key) const {
+        return std::string_view(arena.data() + keys[key].text, keys[key].length);
+    }
+
+    std::vector<char> arena;
+    std::vector<Key> keys;
+    std::vector<std::uint32_t> sorted;          // key indexes by text
+
+    // Keys containing `gram`, in key order
+    std::span<const std::uint32_t> keysWith(std::uint32_t gram) const;
+
+    // Posting lists: keys containing grams[i] are
+    // postings[offsets[i] .. offsets[i + 1]); bigrams carry BigramMark
+    std::vector<std::uint32_t> grams;
+    std::vector<std::uint32_t> offsets;
+    std::vector<std::uint32_t> postings;
+};
+
+#endif // UNITSEARCH_H
@@ -0,0 +1,64 @@
+#ifndef UTF8_H
+#define UTF8_H
+
+#include <QStringView>
+#include <cstddef>
+
+// UTF-16 to UTF-8 into a caller's buffer, for lookups that take UTF-8
+// keys but are handed a QString. Nothing is allocated.
+namespace Utf8 {
+
+struct Encoded {
+    std::size_t size;   // bytes written
+    bool complete;      // false if `text` was cut to fit
+};
+
+// Stops before the first character that does not fit in `capacity` bytes.
+// A surrogate pair becomes one 4-byte sequence; an unpaired surrogate
+// becomes U+FFFD, which no unit name contains.
+inline Encoded encode(QStringView text, char *out, std::size_t capacity)
+{
+    std::size_t n = 0;
+    for (qsizetype i = 0; i < text.size(); ++i) {
+        char32_t c = text[i].unicode();
+        qsizetype units = 1;
+        if (c >= 0xD800 && c <= 0xDFFF) {
+            const char32_t low = i + 1 < text.size() ? text[i + 1].unicode() : 0;
+            if (c <= 0xDBFF && low >= 0xDC00 && low <= 0xDFFF) {
+                c = 0x10000 + ((c - 0xD800) << 10) + (low - 0xDC00);
+                units = 2;
+            } else {
+                c = 0xFFFD;
+            }
+        }
+
+        const std::size_t need = c < 0x80 ? 1 : c < 0x800 ? 2 : c < 0x10000 ? 3 : 4;
+        if (n + need > capacity) return {n, false};
+        switch (need) {
+        case 1:
+            out[n++] = static_cast<char>(c);
+            break;
+        case 2:
+            out[n++] = static_cast<char>(0xC0 | (c >> 6));
+            out[n++] = static_cast<char>(0x80 | (c & 0x3F));
+            break;
+        case 3:
+            out[n++] = static_cast<char>(0xE0 | (c >> 12));
+            out[n++] = static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+            out[n++] = static_cast<char>(0x80 | (c & 0x3F));
+            break;
+        default:
+            out[n++] = static_cast<char>(0xF0 | (c >> 18));
+            out[n++] = static_cast<char>(0x80 | ((c >> 12) & 0x3F));
+            out[n++] = static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+            out[n++] = static_cast<char>(0x80 | (c & 0x3F));
+            break;
+        }
+        i += units - 1;
+    }
+    return {n, true};
+}
+
+} // namespace Utf8
+
+#endif // UTF8_H